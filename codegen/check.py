@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+#
+# Codegen checks: compiles the hot functions with each available compiler, disassembles them with
+# objdump and checks the shape of the machine code, since a refactoring that changes no results
+# can still turn two comparisons into a library call or stop a loop from being vectorized.
+#
+#   python3 codegen/check.py [--cxx COMPILER ...] [--flags "EXTRA FLAGS"]
+#
+# Without --cxx it uses g++ and clang++, whichever are installed. Scalar functions are compiled
+# at -O2; the batch kernels at -O3, since GCC only vectorizes loops needing a scalar epilogue from
+# -O3. The checks are written for x86-64; elsewhere the script reports that and succeeds.
+#
+# Scalar in_int_range(float) and in_int_range(double), from in_range_ext.cpp, and in_port_range(double)
+# (constant bounds), from codegen/kernels.cpp:
+#   no calls or jumps to other functions, exactly two comparisons, and at most
+#   SCALAR_INSTRUCTION_LIMIT instructions.
+# Batch kernels, from codegen/kernels.cpp:
+#   no calls; where the target has the kernel's required instruction set, packed comparisons on
+#   registers at least as wide as the target's vectors (256 bits with AVX2, otherwise 128), in a
+#   loop with no conditional branch besides its own.
+#
+# -------------------------------------------------------------------------------------------------
+# -------------------------------------------------------------------------------------------------
+#
+# MIT License
+#
+# Copyright (c) 2024 stravager
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+
+SCALAR_FUNCTIONS = ['_Z12in_int_rangef', '_Z12in_int_ranged']
+SCALAR_KERNELS = ['in_port_range']
+SCALAR_INSTRUCTION_LIMIT = 10
+
+# Kernel name -> predefined macro the target must have for the kernel to be required to vectorize
+# (None: any x86-64).
+BATCH_KERNELS = {
+    'batch_f32_i32': None,
+    'batch_i32_u8': None,
+    'batch_f64_i32': '__SSE4_2__',
+    'batch_f64_i64': '__SSE4_2__',
+    'batch_i64_i32': '__SSE4_2__',
+    'bitmap_f32_i32': '__AVX2__',
+    'bitmap_f64_i32': '__AVX2__',
+    'convert_f32_q15': None,
+    'convert_f32_q31': None,
+    'convert_f32_i32': None,
+    'pcm_f32_s16': None,
+    'pcm_f32_s24': None,
+    'pcm_f32_s32': None,
+    'export_f32_u8': None,
+    'checked_f32_i32': None,
+    'checked_f64_i32': '__SSE4_2__',
+}
+
+COMPARISON = re.compile(r'^v?u?comis[sd]$')
+PACKED_COMPARISON = re.compile(r'^v?(cmp\w*p[sd]|pcmp\w+)$')
+CONDITIONAL_JUMP = re.compile(r'^j(?!mp)\w+$')
+PADDING = re.compile(r'^(nop\w*|data16|cs|int3|xchg +%ax,%ax)\b')
+REGISTER_BITS = {'xmm': 128, 'ymm': 256, 'zmm': 512}
+
+
+class Instruction:
+    def __init__(self, address, mnemonic, operands):
+        self.address = address
+        self.mnemonic = mnemonic
+        self.operands = operands
+
+    def target(self):
+        match = re.match(r'([0-9a-f]+) <', self.operands)
+        return int(match.group(1), 16) if match else None
+
+
+def disassemble(obj, symbol):
+    output = subprocess.run(['objdump', '-d', '--no-show-raw-insn', f'--disassemble={symbol}', obj], check=True, capture_output=True,
+                            text=True).stdout
+    instructions = []
+    for line in output.splitlines():
+        match = re.match(r'\s*([0-9a-f]+):\s+(\S+)\s*(.*)', line)
+        if match:
+            instructions.append(Instruction(int(match.group(1), 16), match.group(2), match.group(3)))
+    # Alignment padding is not executed.
+    return [i for i in instructions if not PADDING.match(f'{i.mnemonic} {i.operands}')]
+
+
+def outside_calls(instructions):
+    first, last = instructions[0].address, instructions[-1].address
+    calls = []
+    for i in instructions:
+        target = i.target()
+        if i.mnemonic.startswith('call') or (i.mnemonic.startswith('jmp') and (target is None or not first <= target <= last)):
+            calls.append(f'{i.mnemonic} {i.operands}')
+    return calls
+
+
+def predefined(cxx, flags):
+    output = subprocess.run([cxx, '-std=c++20', *flags, '-dM', '-E', '-x', 'c++', os.devnull], check=True, capture_output=True, text=True).stdout
+    return {line.split()[1] for line in output.splitlines() if line.startswith('#define ')}
+
+
+def compile_object(cxx, source, obj, flags):
+    subprocess.run([cxx, '-std=c++20', *flags, '-c', source, '-o', obj], check=True)
+
+
+def check_scalar(obj, symbol):
+    instructions = disassemble(obj, symbol)
+    if not instructions:
+        return [f'{symbol}: not found']
+    errors = [f'{symbol}: calls {call}' for call in outside_calls(instructions)]
+    comparisons = sum(1 for i in instructions if COMPARISON.match(i.mnemonic))
+    if comparisons != 2:
+        errors.append(f'{symbol}: {comparisons} comparisons, expected 2')
+    if len(instructions) > SCALAR_INSTRUCTION_LIMIT:
+        errors.append(f'{symbol}: {len(instructions)} instructions, limit {SCALAR_INSTRUCTION_LIMIT}')
+    print(f'  {symbol}: {len(instructions)} instructions')
+    return errors
+
+
+def check_kernel(obj, symbol, required, macros):
+    instructions = disassemble(obj, symbol)
+    if not instructions:
+        return [f'{symbol}: not found']
+    errors = [f'{symbol}: calls {call}' for call in outside_calls(instructions)]
+    if required is not None and required not in macros:
+        print(f'  {symbol}: {len(instructions)} instructions (vectorization not required without {required})')
+        return errors
+
+    # The vector loop: the innermost backward branch whose body contains a packed comparison.
+    loops = []
+    for k, i in enumerate(instructions):
+        target = i.target()
+        if CONDITIONAL_JUMP.match(i.mnemonic) and target is not None and target <= i.address:
+            body = [j for j in instructions[:k + 1] if j.address >= target]
+            if any(PACKED_COMPARISON.match(j.mnemonic) for j in body):
+                loops.append(body)
+    if not loops:
+        return errors + [f'{symbol}: no vectorized loop']
+    body = min(loops, key=len)
+
+    expected_bits = 256 if '__AVX2__' in macros else 128
+    bits = max((REGISTER_BITS[r] for j in body if PACKED_COMPARISON.match(j.mnemonic) for r in re.findall(r'%([xyz]mm)', j.operands)), default=0)
+    if bits < expected_bits:
+        errors.append(f'{symbol}: comparisons on {bits}-bit vectors, expected {expected_bits}')
+    branches = [j for j in body[:-1] if CONDITIONAL_JUMP.match(j.mnemonic)]
+    if branches:
+        errors.append(f'{symbol}: {len(branches)} conditional branches inside the vector loop')
+    print(f'  {symbol}: {len(instructions)} instructions, loop of {len(body)} with {bits}-bit comparisons')
+    return errors
+
+
+def check_compiler(cxx, flags, directory):
+    macros = predefined(cxx, flags)
+    if '__x86_64__' not in macros:
+        print(f'{cxx}: skipped, the checks are written for x86-64')
+        return []
+    print(f'{cxx} {" ".join(flags)}')
+    scalar = os.path.join(directory, 'scalar.o')
+    compile_object(cxx, os.path.join(ROOT, 'in_range_ext.cpp'), scalar, ['-O2', *flags])
+    errors = []
+    for symbol in SCALAR_FUNCTIONS:
+        errors += check_scalar(scalar, symbol)
+    kernels = os.path.join(directory, 'kernels.o')
+    compile_object(cxx, os.path.join(HERE, 'kernels.cpp'), kernels, ['-O3', *flags])
+    for symbol in SCALAR_KERNELS:
+        errors += check_scalar(kernels, symbol)
+    for symbol, required in BATCH_KERNELS.items():
+        errors += check_kernel(kernels, symbol, required, macros)
+    return [f'{cxx}: {error}' for error in errors]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Checks the machine code of the hot functions.')
+    parser.add_argument('--cxx', action='append', help='compiler to check (repeatable)')
+    parser.add_argument('--flags', default='', help='extra compiler flags, such as -march=x86-64-v3')
+    args = parser.parse_args()
+
+    compilers = args.cxx or [cxx for cxx in ('g++', 'clang++') if shutil.which(cxx)]
+    if not compilers:
+        sys.exit('no compiler found')
+    errors = []
+    with tempfile.TemporaryDirectory() as directory:
+        for cxx in compilers:
+            errors += check_compiler(cxx, args.flags.split(), directory)
+    for error in errors:
+        print(error, file=sys.stderr)
+    print('codegen: FAILED' if errors else 'codegen: OK')
+    return 1 if errors else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
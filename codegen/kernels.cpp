@@ -0,0 +1,100 @@
+//
+// Instantiations of the batch kernels, and of scalar forms not in in_range_ext.cpp, with C linkage,
+// compiled on their own by check.py so that their machine code can be inspected.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "../in_range_ext.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#define IN_RANGE_EXT_BATCH_KERNEL(name, Dst, Src)                                                                                                             \
+    extern "C" std::size_t name(const Src *src, std::size_t n, bool *mask)                                                                                    \
+    {                                                                                                                                                         \
+        return in_range_ext::in_range<Dst>(std::span<const Src>(src, n), std::span<bool>(mask, n));                                                           \
+    }
+
+#define IN_RANGE_EXT_BITMAP_KERNEL(name, Dst, Src)                                                                                                            \
+    extern "C" std::size_t name(const Src *src, std::size_t n, const std::uint8_t *validity, std::uint8_t *bitmap)                                            \
+    {                                                                                                                                                         \
+        return in_range_ext::in_range<Dst>(std::span<const Src>(src, n), validity, 0, bitmap);                                                                \
+    }
+
+IN_RANGE_EXT_BATCH_KERNEL(batch_f32_i32, std::int32_t, float)
+IN_RANGE_EXT_BATCH_KERNEL(batch_f64_i32, std::int32_t, double)
+IN_RANGE_EXT_BATCH_KERNEL(batch_f64_i64, std::int64_t, double)
+IN_RANGE_EXT_BATCH_KERNEL(batch_i32_u8, std::uint8_t, std::int32_t)
+IN_RANGE_EXT_BATCH_KERNEL(batch_i64_i32, std::int32_t, std::int64_t)
+IN_RANGE_EXT_BITMAP_KERNEL(bitmap_f32_i32, std::int32_t, float)
+IN_RANGE_EXT_BITMAP_KERNEL(bitmap_f64_i32, std::int32_t, double)
+
+using q15 = in_range_ext::fixed_point<std::int16_t, 15>;
+using q31 = in_range_ext::fixed_point<std::int32_t, 31>;
+
+#define IN_RANGE_EXT_CONVERT_KERNEL(name, Dst, Src)                                                                                                           \
+    extern "C" std::size_t name(const Src *src, std::size_t n, Dst *dst)                                                                                      \
+    {                                                                                                                                                         \
+        return in_range_ext::convert_saturating(std::span<const Src>(src, n), std::span<Dst>(dst, n));                                                        \
+    }
+
+IN_RANGE_EXT_CONVERT_KERNEL(convert_f32_q15, q15, float)
+IN_RANGE_EXT_CONVERT_KERNEL(convert_f32_q31, q31, float)
+IN_RANGE_EXT_CONVERT_KERNEL(convert_f32_i32, std::int32_t, float)
+
+// Stereo PCM, with the number of frames given, as for an audio callback.
+#define IN_RANGE_EXT_PCM_KERNEL(name, bits, Sample)                                                                                                           \
+    extern "C" std::size_t name(const float *src, std::size_t frames, Sample *dst, std::size_t *clips)                                                        \
+    {                                                                                                                                                         \
+        return in_range_ext::convert_pcm<bits>(std::span<const float>(src, 2 * frames), 2, std::span<Sample>(dst, 2 * frames),                                \
+                                               std::span<std::size_t>(clips, 2));                                                                             \
+    }
+
+IN_RANGE_EXT_PCM_KERNEL(pcm_f32_s16, 16, std::int16_t)
+IN_RANGE_EXT_PCM_KERNEL(pcm_f32_s24, 24, std::int32_t)
+IN_RANGE_EXT_PCM_KERNEL(pcm_f32_s32, 32, std::int32_t)
+
+extern "C" in_range_ext::export_u8_result export_f32_u8(const float *src, std::size_t n, std::uint8_t *dst, std::uint8_t nan_value)
+{
+    return in_range_ext::export_u8(std::span<const float>(src, n), std::span<std::uint8_t>(dst, n), {.nan_value = nan_value});
+}
+
+#define IN_RANGE_EXT_CHECKED_KERNEL(name, Dst, Src)                                                                                                           \
+    extern "C" std::size_t name(const Src *src, std::size_t n, Dst *dst, bool *mask)                                                                          \
+    {                                                                                                                                                         \
+        return in_range_ext::convert_checked(std::span<const Src>(src, n), std::span<Dst>(dst, n), std::span<bool>(mask, n));                                 \
+    }
+
+IN_RANGE_EXT_CHECKED_KERNEL(checked_f32_i32, std::int32_t, float)
+IN_RANGE_EXT_CHECKED_KERNEL(checked_f64_i32, std::int32_t, double)
+
+// A port number given as a double, checked against bounds fixed at compile time.
+extern "C" bool in_port_range(double f)
+{
+    return in_range_ext::in_range<0, 65535>(f);
+}
@@ -0,0 +1,233 @@
+//
+// Fuzz target: the batch forms (contiguous, strided, nullable, dictionary, run-length, FOR blocks)
+// and range_validator, element by element against the exact reference.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "reference.h"
+
+#include <memory>
+#include <span>
+
+using namespace in_range_ext_fuzz;
+
+namespace
+{
+// Fails if mask (or count) disagrees with expected; values[k] is reported for the first difference.
+template <class Dst, class Src>
+void check_mask(const char *what, const std::vector<Src> &values, const std::vector<std::size_t> &positions, const std::vector<bool> &expected,
+                const bool *mask, std::size_t count)
+{
+    for (std::size_t k = 0; k < expected.size(); ++k)
+        if (mask[k] != expected[k])
+            mismatch<Dst>(what, values[positions[k]]);
+    if (count != std::size_t(std::count(expected.begin(), expected.end(), true)))
+        mismatch<Dst>(what, Src{});
+}
+
+bool bit(const std::uint8_t *bitmap, std::size_t k)
+{
+    return (bitmap[k / 8] >> (k % 8)) & 1;
+}
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    fuzz_input input(data, size);
+    const std::uint8_t dst = input.byte(), src = input.byte();
+    visit_type(tested_types{}, dst, [&]<class Dst>() {
+        visit_type(tested_types{}, src, [&]<class Src>() {
+            const std::size_t n = input.byte() % 48;
+            std::vector<Src> values(n);
+            std::vector<bool> expected(n);
+            std::vector<std::size_t> identity(n);
+            for (std::size_t k = 0; k < n; ++k)
+            {
+                values[k] = input.value<Src>();
+                expected[k] = reference_in_range<Dst>(values[k]);
+                identity[k] = k;
+            }
+            const std::unique_ptr<bool[]> mask(new bool[3 * n + 48]());
+
+            // Contiguous.
+            std::size_t count = in_range_ext::in_range<Dst>(std::span<const Src>(values), std::span<bool>(mask.get(), n));
+            check_mask<Dst>("batch", values, identity, expected, mask.get(), count);
+
+            // Strided: every other element, into every third mask element.
+            std::vector<Src> interleaved(2 * n);
+            for (std::size_t k = 0; k < n; ++k)
+                interleaved[2 * k] = values[k];
+            count = in_range_ext::in_range_strided<Dst>(interleaved.data(), 2, n, mask.get(), 3);
+            for (std::size_t k = 0; k < n; ++k)
+                if (mask[3 * k] != expected[k])
+                    mismatch<Dst>("strided", values[k]);
+            if (count != std::size_t(std::count(expected.begin(), expected.end(), true)))
+                mismatch<Dst>("strided count", Src{});
+
+            // Nullable, with both outputs.
+            const std::size_t validity_offset = input.byte() % 8;
+            std::vector<std::uint8_t> validity((validity_offset + n + 7) / 8 + 1);
+            for (std::uint8_t &byte : validity)
+                byte = input.byte();
+            std::vector<bool> expected_nullable(n);
+            for (std::size_t k = 0; k < n; ++k)
+                expected_nullable[k] = expected[k] && bit(validity.data(), validity_offset + k);
+            count = in_range_ext::in_range<Dst>(std::span<const Src>(values), validity.data(), validity_offset, std::span<bool>(mask.get(), n));
+            check_mask<Dst>("nullable", values, identity, expected_nullable, mask.get(), count);
+            std::vector<std::uint8_t> bitmap((n + 7) / 8);
+            count = in_range_ext::in_range<Dst>(std::span<const Src>(values), validity.data(), validity_offset, bitmap.data());
+            for (std::size_t k = 0; k < n; ++k)
+                mask[k] = bit(bitmap.data(), k);
+            check_mask<Dst>("nullable bitmap", values, identity, expected_nullable, mask.get(), count);
+
+            // Checked conversion, comparing first, converting first, by flags and adaptively, with the values checked exactly.
+            if constexpr (in_range_ext::integer<Dst> && std::floating_point<Src>)
+            {
+                std::vector<Dst> converted(n);
+                for (const auto convert : {&in_range_ext::convert_checked<Dst, Src>, &in_range_ext::convert_optimistic<Dst, Src>, &in_range_ext::convert_fe_checked<Dst, Src>})
+                {
+                    count = convert(std::span<const Src>(values), std::span<Dst>(converted), std::span<bool>(mask.get(), n));
+                    check_mask<Dst>("convert", values, identity, expected, mask.get(), count);
+                    for (std::size_t k = 0; k < n; ++k)
+                        if (expected[k] ? !(bigint::of(converted[k]) == truncated(values[k])) : converted[k] != 0)
+                            mismatch<Dst>("convert value", values[k]);
+                }
+
+                // Adaptively, in small blocks and two chunks, so that the strategy changes along the way.
+                in_range_ext::adaptive_converter<Dst, Src> converter(1 + input.byte() % 16);
+                const std::size_t split = input.byte() % (n + 1);
+                count = converter.convert(std::span<const Src>(values).first(split), std::span<Dst>(converted), std::span<bool>(mask.get(), split));
+                count += converter.convert(std::span<const Src>(values).subspan(split), std::span<Dst>(converted).subspan(split),
+                                           std::span<bool>(mask.get() + split, n - split));
+                check_mask<Dst>("adaptive convert", values, identity, expected, mask.get(), count);
+                for (std::size_t k = 0; k < n; ++k)
+                    if (expected[k] ? !(bigint::of(converted[k]) == truncated(values[k])) : converted[k] != 0)
+                        mismatch<Dst>("adaptive convert value", values[k]);
+                if (converter.stats().count != n || converter.stats().num_in_range != count)
+                    mismatch<Dst>("adaptive convert stats", Src{});
+            }
+
+            // Dictionary-encoded, with the values as dictionary.
+            if (n != 0)
+            {
+                const std::size_t rows = input.byte() % 48;
+                std::vector<std::uint8_t> indices(rows);
+                std::vector<std::size_t> positions(rows);
+                std::vector<bool> expected_rows(rows), expected_rows_nullable(rows);
+                std::vector<std::uint8_t> row_validity((rows + 7) / 8 + 1);
+                for (std::uint8_t &byte : row_validity)
+                    byte = input.byte();
+                for (std::size_t k = 0; k < rows; ++k)
+                {
+                    positions[k] = input.byte() % n;
+                    indices[k] = std::uint8_t(positions[k]);
+                    expected_rows[k] = expected[positions[k]];
+                    expected_rows_nullable[k] = expected_rows[k] && bit(row_validity.data(), k);
+                }
+                count = in_range_ext::in_range_dict<Dst>(std::span<const Src>(values), std::span<const std::uint8_t>(indices), std::span<bool>(mask.get(), rows));
+                check_mask<Dst>("dictionary", values, positions, expected_rows, mask.get(), count);
+
+                for (std::size_t k = 0; k < rows; ++k)
+                    if (!bit(row_validity.data(), k))
+                        indices[k] = 0xff; // Null rows' indices need not be valid.
+                std::vector<std::uint8_t> row_bitmap((rows + 7) / 8);
+                count = in_range_ext::in_range_dict<Dst>(std::span<const Src>(values), std::span<const std::uint8_t>(indices), row_validity.data(), 0,
+                                                         row_bitmap.data());
+                for (std::size_t k = 0; k < rows; ++k)
+                    mask[k] = bit(row_bitmap.data(), k);
+                check_mask<Dst>("dictionary bitmap", values, positions, expected_rows_nullable, mask.get(), count);
+            }
+
+            // Run-length-encoded, with the values as runs of 0 to 3 rows.
+            {
+                std::vector<std::uint8_t> lengths(n);
+                std::vector<std::size_t> positions;
+                std::vector<bool> expected_rows;
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    lengths[k] = input.byte() % 4;
+                    positions.insert(positions.end(), lengths[k], k);
+                    expected_rows.insert(expected_rows.end(), lengths[k], expected[k]);
+                }
+                count = in_range_ext::in_range_rle<Dst>(std::span<const Src>(values), std::span<const std::uint8_t>(lengths),
+                                                        std::span<bool>(mask.get(), expected_rows.size()));
+                check_mask<Dst>("run-length", values, positions, expected_rows, mask.get(), count);
+            }
+
+            // Streaming statistics, fed in two chunks.
+            {
+                const std::size_t split = input.byte() % (n + 1);
+                in_range_ext::range_validator<Dst, Src> validator;
+                validator.feed(std::span<const Src>(values).first(split));
+                validator.feed(std::span<const Src>(values).subspan(split));
+                const in_range_ext::range_stats<Src> &stats = validator.stats();
+                std::size_t outcomes[4] = {}, first_failure = stats.npos;
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    const in_range_ext::range_outcome outcome = reference_outcome<Dst>(values[k]);
+                    ++outcomes[std::size_t(outcome)];
+                    if (outcome != in_range_ext::range_outcome::in_range && first_failure == stats.npos)
+                        first_failure = k;
+                }
+                if (stats.count != n || stats.num_in_range != outcomes[0] || stats.num_nan != outcomes[1] || stats.num_above != outcomes[2] ||
+                    stats.num_below != outcomes[3] || stats.first_failure != first_failure)
+                    mismatch<Dst>("range_validator", first_failure < n ? values[first_failure] : Src{});
+            }
+
+            // Frame-of-reference block, based at the first value.
+            if constexpr (in_range_ext::integer<Src>)
+            {
+                using U = std::make_unsigned_t<Src>;
+                const Src base = n != 0 ? values[0] : Src{};
+                const unsigned bit_width = input.byte() % (std::numeric_limits<U>::digits + 1);
+                const std::size_t rows = input.byte() % 48;
+                std::vector<std::uint8_t> packed((rows * bit_width + 7) / 8);
+                for (std::uint8_t &byte : packed)
+                    byte = input.byte();
+                std::vector<Src> unpacked(rows);
+                std::vector<std::size_t> positions(rows);
+                std::vector<bool> expected_rows(rows);
+                for (std::size_t k = 0; k < rows; ++k)
+                {
+                    U delta = 0;
+                    for (unsigned b = 0; b < bit_width; ++b)
+                        delta |= U(U(bit(packed.data(), k * bit_width + b)) << b);
+                    unpacked[k] = Src(U(U(base) + delta));
+                    positions[k] = k;
+                    expected_rows[k] = reference_in_range<Dst>(unpacked[k]);
+                }
+                const in_range_ext::for_block<Src> block{base, bit_width, rows, packed.data()};
+                count = in_range_ext::in_range_for<Dst>(block, std::span<bool>(mask.get(), rows));
+                check_mask<Dst>("FOR block", unpacked, positions, expected_rows, mask.get(), count);
+                if (in_range_ext::all_in_range_for<Dst>(std::span<const in_range_ext::for_block<Src>>(&block, 1)) !=
+                    std::all_of(expected_rows.begin(), expected_rows.end(), [](bool in) { return in; }))
+                    mismatch<Dst>("all_in_range_for", base);
+            }
+        });
+    });
+    return 0;
+}
@@ -0,0 +1,121 @@
+//
+// Fuzz target: numeric_cast with each policy, every pair of tested types, against the exact
+// reference: converted values must be the source rounded toward zero (for integer destinations),
+// and failures must report the reference outcome and saturate to the right limit.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "reference.h"
+
+#include <cerrno>
+
+using namespace in_range_ext_fuzz;
+
+namespace
+{
+template <class T> bool same_value(T a, T b)
+{
+    if constexpr (std::floating_point<T>)
+        if (a != a || b != b)
+            return a != a && b != b;
+    return a == b;
+}
+
+// What the conversion of s should produce: s itself when in range, otherwise the limit on its side
+// (infinity from infinity for floating-point Dst), and for NaN 0 or NaN.
+template <class Dst, class Src> Dst expected_value(Src s, in_range_ext::range_outcome outcome)
+{
+    using dlimits = std::numeric_limits<Dst>;
+    switch (outcome)
+    {
+    case in_range_ext::range_outcome::in_range:
+        return static_cast<Dst>(s);
+    case in_range_ext::range_outcome::nan:
+        return std::floating_point<Dst> ? dlimits::quiet_NaN() : Dst(0);
+    case in_range_ext::range_outcome::above:
+        return std::floating_point<Dst> && exact(s).infinity != 0 ? dlimits::infinity() : dlimits::max();
+    case in_range_ext::range_outcome::below:
+        break;
+    }
+    return std::floating_point<Dst> && exact(s).infinity != 0 ? -dlimits::infinity() : dlimits::lowest();
+}
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    fuzz_input input(data, size);
+    const std::uint8_t dst = input.byte(), src = input.byte();
+    visit_type(tested_types{}, dst, [&]<class Dst>() {
+        visit_type(tested_types{}, src, [&]<class Src>() {
+            const Src s = input.value<Src>();
+            const in_range_ext::range_outcome outcome = reference_outcome<Dst>(s);
+            const bool in = outcome == in_range_ext::range_outcome::in_range;
+
+            // For integer destinations the in-range conversion itself is checked exactly, not
+            // against static_cast.
+            const Dst saturated = in_range_ext::numeric_cast<Dst, in_range_ext::saturate_on_failure>(s);
+            if (!same_value(saturated, expected_value<Dst>(s, outcome)))
+                mismatch<Dst>("numeric_cast<saturate_on_failure>", s);
+            if constexpr (!std::floating_point<Dst>)
+                if (in && !(bigint::of(saturated) == truncated(s)))
+                    mismatch<Dst>("numeric_cast value", s);
+
+            errno = 0;
+            const Dst with_errno = in_range_ext::numeric_cast<Dst, in_range_ext::errno_on_failure>(s);
+            const int expected_errno = in ? 0 : outcome == in_range_ext::range_outcome::nan ? EDOM : ERANGE;
+            if (!same_value(with_errno, saturated) || errno != expected_errno)
+                mismatch<Dst>("numeric_cast<errno_on_failure>", s);
+
+            try
+            {
+                const Dst thrown = in_range_ext::numeric_cast<Dst>(s);
+                if (!in || !same_value(thrown, saturated))
+                    mismatch<Dst>("numeric_cast<throw_on_failure>", s);
+            }
+            catch (const in_range_ext::bad_numeric_cast &e)
+            {
+                if (in || e.outcome() != outcome)
+                    mismatch<Dst>("numeric_cast<throw_on_failure> exception", s);
+            }
+
+            if constexpr (in_range_ext::integer<Dst> && std::floating_point<Src>)
+            {
+                Dst converted;
+                const std::size_t count = in_range_ext::convert_saturating(std::span<const Src>(&s, 1), std::span<Dst>(&converted, 1));
+                if (count != !in || converted != saturated)
+                    mismatch<Dst>("convert_saturating", s);
+            }
+
+#if defined __cpp_lib_expected && __cpp_lib_expected >= 202202L
+            const auto expected = in_range_ext::numeric_cast<Dst, in_range_ext::expected_on_failure>(s);
+            if (expected.has_value() != in || (in ? !same_value(*expected, saturated) : expected.error() != outcome))
+                mismatch<Dst>("numeric_cast<expected_on_failure>", s);
+#endif
+        });
+    });
+    return 0;
+}
@@ -0,0 +1,250 @@
+//
+// Fuzz target: parse_to_integer and parse_column against a reference that reads the text into an
+// exact decimal value (digits times a power of 10) and classifies that.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "reference.h"
+
+#include <charconv>
+#include <memory>
+#include <span>
+#include <string>
+
+using namespace in_range_ext_fuzz;
+
+namespace
+{
+bool equal_ignoring_case(std::string_view a, std::string_view lower)
+{
+    return a.size() == lower.size() && std::equal(a.begin(), a.end(), lower.begin(), [](char x, char y) { return (x | 0x20) == y; });
+}
+
+// The value of text as parse_to_integer<I> should report it, parsed independently: the digits are
+// read into a bigint and compared with the limits scaled by the same power of 10.
+template <class I> in_range_ext::parse_result<I> reference_parse(std::string_view text)
+{
+    using in_range_ext::parse_status;
+    std::size_t p = 0;
+    const bool negative = p < text.size() && text[p] == '-';
+    p += p < text.size() && (text[p] == '-' || text[p] == '+');
+    const parse_status out_of_range = negative ? parse_status::below : parse_status::above;
+    const std::string_view rest = text.substr(p);
+    if (equal_ignoring_case(rest, "inf") || equal_ignoring_case(rest, "infinity"))
+        return {{}, out_of_range};
+    if (equal_ignoring_case(rest, "nan"))
+        return {{}, parse_status::not_integer};
+
+    // value = digits * 10^scale
+    bigint digits;
+    std::size_t num_digits = 0;
+    long scale = 0;
+    bool point = false;
+    for (; p < text.size() && ((text[p] >= '0' && text[p] <= '9') || (text[p] == '.' && !point)); ++p)
+    {
+        if (text[p] == '.')
+        {
+            point = true;
+            continue;
+        }
+        ++num_digits;
+        digits.multiply_add(10, std::uint32_t(text[p] - '0'));
+        scale -= point;
+    }
+    if (num_digits == 0)
+        return {};
+    if (p < text.size() && (text[p] == 'e' || text[p] == 'E'))
+    {
+        ++p;
+        const bool negative_exponent = p < text.size() && text[p] == '-';
+        p += p < text.size() && (text[p] == '-' || text[p] == '+');
+        if (p == text.size() || text[p] < '0' || text[p] > '9')
+            return {};
+        long exponent = 0;
+        for (; p < text.size() && text[p] >= '0' && text[p] <= '9'; ++p)
+            exponent = std::min(exponent * 10 + (text[p] - '0'), 1000000L); // Far beyond the digits there can be.
+        scale += negative_exponent ? -exponent : exponent;
+    }
+    if (p != text.size())
+        return {};
+
+    if (digits.is_zero())
+        return {I(0), parse_status::ok};
+    if (negative && !std::numeric_limits<I>::is_signed)
+        return {{}, parse_status::below};
+    for (bigint quotient = digits; quotient.divide(10) == 0; quotient = digits)
+    {
+        digits = quotient;
+        ++scale;
+    }
+
+    // |value| against the limit on its side of zero, both scaled to integers. With a scale above 40
+    // the value is beyond any limit; with one below -num_digits it is a nonzero fraction.
+    bigint limit = negative ? bigint::of(std::numeric_limits<I>::lowest()) : bigint::of(std::numeric_limits<I>::max());
+    if (negative)
+        limit.negate();
+    if (scale > 40)
+        return {{}, out_of_range};
+    if (scale < -long(num_digits))
+        return {{}, parse_status::not_integer};
+    bigint value = digits;
+    for (long k = 0; k < scale; ++k)
+        value.multiply_add(10, 0);
+    for (long k = 0; k < -scale; ++k)
+        limit.multiply_add(10, 0);
+    if (compare(value, limit) > 0)
+        return {{}, out_of_range};
+    if (scale < 0)
+        return {{}, parse_status::not_integer};
+    // In range and an integer: value fits in uintmax_t.
+    std::uintmax_t magnitude = 0;
+    for (std::uintmax_t unit = 1; !value.is_zero(); unit *= 10)
+        magnitude += value.divide(10) * unit;
+    return {negative ? I(std::uintmax_t(0) - magnitude) : I(magnitude), parse_status::ok};
+}
+
+// Text for one number: either arbitrary characters from those numbers are made of, or a value
+// near a boundary of some type written in a variety of forms.
+std::string make_number(fuzz_input &input)
+{
+    const std::uint8_t mode = input.byte();
+    std::string text;
+    if (mode % 4 == 0)
+    {
+        constexpr std::string_view alphabet = "0123456789.-+eE0000infatyNI";
+        for (std::size_t n = input.byte() % 24; n != 0; --n)
+            text += alphabet[input.byte() % alphabet.size()];
+        return text;
+    }
+
+    text = mode % 8 < 4 ? std::to_string(input.value<std::int64_t>()) : std::to_string(input.value<std::uint64_t>());
+    const std::size_t sign = text.front() == '-';
+    if (mode & 8)
+        text.insert(sign, input.byte() % 4, '0'); // Leading zeros.
+    switch (mode / 16 % 8)
+    {
+    case 0:
+        break;
+    case 1:
+        text += "." + std::string(input.byte() % 4, '0'); // Possibly "123." or "123.000".
+        break;
+    case 2:
+        text += "." + std::string(input.byte() % 24, '0') + char('1' + input.byte() % 9); // Just above an integer.
+        break;
+    case 3:
+        // Scientific notation, d.ddd...eN, possibly scaled by a power of 10.
+        text.insert(sign + 1, ".");
+        text += "e" + std::to_string(long(text.size() - sign) - 2 + int(input.byte() % 7) - 3);
+        break;
+    case 4:
+        text += "e" + std::to_string(int(input.byte() % 48) - 24);
+        break;
+    case 5:
+        text += std::string(input.byte() % 4, '0') + "e-" + std::to_string(input.byte() % 4);
+        break;
+    case 6:
+        text = (mode & 1 ? "-" : "") + std::string(input.byte() % 2 ? "0." : ".") + text.substr(sign) + "e" + std::to_string(text.size() - sign);
+        break;
+    default:
+        text.insert(0, mode & 1 ? "+" : "");
+        break;
+    }
+    return text;
+}
+
+bool bit(const std::uint8_t *bitmap, std::size_t k)
+{
+    return (bitmap[k / 8] >> (k % 8)) & 1;
+}
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    fuzz_input input(data, size);
+    const std::uint8_t type = input.byte();
+    visit_type(tested_types{}, type, [&]<class T>() {
+        std::vector<std::string> fields(input.byte() % 24);
+        for (std::string &field : fields)
+            field = make_number(input);
+
+        if constexpr (!std::floating_point<T>)
+            for (const std::string &field : fields)
+            {
+                const in_range_ext::parse_result<T> result = in_range_ext::parse_to_integer<T>(field);
+                const in_range_ext::parse_result<T> expected = reference_parse<T>(field);
+                if (result.status != expected.status || (expected && result.value != expected.value))
+                {
+                    std::fprintf(stderr, "  text = \"%s\"\n", field.c_str());
+                    mismatch<T>("parse_to_integer", T{});
+                }
+            }
+
+        // The column, in a buffer of exactly its size so that reading past it is caught.
+        const char delimiter = input.byte() % 2 ? ',' : '\n';
+        std::string joined;
+        for (const std::string &field : fields)
+            joined += field + (delimiter == '\n' && input.byte() % 4 == 0 ? "\r\n" : std::string(1, delimiter));
+        if (!fields.empty() && !fields.back().empty() && input.byte() % 2)
+            joined.pop_back(); // No delimiter after the last field (which must not be empty).
+        if (delimiter == '\n' && !joined.empty() && joined.back() == '\r')
+            joined.pop_back();
+        const std::unique_ptr<char[]> text(new char[joined.size()]);
+        std::memcpy(text.get(), joined.data(), joined.size());
+        std::vector<T> values(fields.size());
+        std::vector<std::uint8_t> validity((fields.size() + 7) / 8);
+        const in_range_ext::column_parse_result result =
+            in_range_ext::parse_column(std::string_view(text.get(), joined.size()), delimiter, std::span<T>(values), validity.data());
+
+        std::size_t valid = 0;
+        for (std::size_t k = 0; k < fields.size(); ++k)
+        {
+            T expected{};
+            bool ok = false;
+            if constexpr (std::floating_point<T>)
+            {
+                const auto [ptr, ec] = std::from_chars(fields[k].data(), fields[k].data() + fields[k].size(), expected);
+                ok = !fields[k].empty() && ec == std::errc{} && ptr == fields[k].data() + fields[k].size();
+            }
+            else
+            {
+                const in_range_ext::parse_result<T> reference = reference_parse<T>(fields[k]);
+                ok = bool(reference);
+                expected = reference.value;
+            }
+            expected = ok ? expected : T{};
+            valid += ok;
+            if (bit(validity.data(), k) != ok || !(values[k] == expected || (values[k] != values[k] && expected != expected)))
+            {
+                std::fprintf(stderr, "  field %zu = \"%s\"\n", k, fields[k].c_str());
+                mismatch<T>("parse_column", values[k]);
+            }
+        }
+        if (result.fields != fields.size() || result.valid != valid)
+            mismatch<T>("parse_column count", T{});
+    });
+    return 0;
+}
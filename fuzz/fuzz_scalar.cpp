@@ -0,0 +1,65 @@
+//
+// Fuzz target: scalar in_range and range_outcome_of, every pair of tested types in every direction,
+// and in_range_bounds, against the exact reference.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "reference.h"
+
+using namespace in_range_ext_fuzz;
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    fuzz_input input(data, size);
+    const std::uint8_t dst = input.byte(), src = input.byte();
+    visit_type(tested_types{}, dst, [&]<class Dst>() {
+        visit_type(tested_types{}, src, [&]<class Src>() {
+            const Src s = input.value<Src>();
+            const in_range_ext::range_outcome expected = reference_outcome<Dst>(s);
+            if (in_range_ext::in_range<Dst>(s) != (expected == in_range_ext::range_outcome::in_range))
+                mismatch<Dst>("in_range", s);
+            if (in_range_ext::range_outcome_of<Dst>(s) != expected)
+                mismatch<Dst>("range_outcome_of", s);
+
+            // Runtime bounds, taking Dst's limits to pick the integer type of the interval.
+            if constexpr (std::floating_point<Src> && !std::floating_point<Dst>)
+            {
+                const Dst lo = input.value<Dst>(), hi = input.value<Dst>();
+                const exact_value x = exact(s);
+                const bool in = !x.nan && x.infinity == 0 && compare(x, exact(lo)) >= 0 && compare(x, exact(hi)) <= 0;
+                if (in_range_ext::in_range_bounds(s, lo, hi) != in)
+                    mismatch<Dst>("in_range_bounds", s);
+            }
+
+            // The rounding used by convert_pcm, against the C library's.
+            if constexpr (std::floating_point<Src>)
+                if (s == s && in_range_ext::detail::round_to_even(s) != std::nearbyint(s))
+                    mismatch<Dst>("round_to_even", s);
+        });
+    });
+    return 0;
+}
@@ -0,0 +1,416 @@
+//
+// Exact reference results and shared input handling for the fuzz targets.
+//
+// The reference does not share any code with in_range_ext.h: values are expanded to exact
+// arbitrary-precision integers times powers of 2 (or of 10, for text) and compared directly, so the
+// decomp engine, the precomputed bounds and the fast paths are all checked against it.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IN_RANGE_EXT_FUZZ_REFERENCE_H
+#define IN_RANGE_EXT_FUZZ_REFERENCE_H
+
+#include "../in_range_ext.h"
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace in_range_ext_fuzz
+{
+// Arbitrary-precision integer: sign and magnitude, the magnitude in 32-bit limbs, least significant
+// first, without leading zero limbs.
+class bigint
+{
+    bool negative = false;
+    std::vector<std::uint32_t> limbs;
+
+    void trim()
+    {
+        while (!limbs.empty() && limbs.back() == 0)
+            limbs.pop_back();
+        negative = negative && !limbs.empty();
+    }
+
+    static int compare_magnitude(const bigint &a, const bigint &b)
+    {
+        if (a.limbs.size() != b.limbs.size())
+            return a.limbs.size() < b.limbs.size() ? -1 : 1;
+        for (std::size_t k = a.limbs.size(); k-- != 0;)
+            if (a.limbs[k] != b.limbs[k])
+                return a.limbs[k] < b.limbs[k] ? -1 : 1;
+        return 0;
+    }
+
+public:
+    bigint() = default;
+
+    template <std::integral I> static bigint of(I i)
+    {
+        bigint b;
+        b.negative = i < 0;
+        std::uintmax_t magnitude = b.negative ? std::uintmax_t(0) - std::uintmax_t(i) : std::uintmax_t(i);
+        for (; magnitude != 0; magnitude >>= 32)
+            b.limbs.push_back(std::uint32_t(magnitude));
+        return b;
+    }
+
+    bool is_zero() const
+    {
+        return limbs.empty();
+    }
+
+    void negate()
+    {
+        negative = !negative;
+        trim();
+    }
+
+    void shift_left(std::size_t bits)
+    {
+        if (is_zero())
+            return;
+        limbs.insert(limbs.begin(), bits / 32, 0);
+        if (const unsigned shift = unsigned(bits % 32); shift != 0)
+        {
+            const std::size_t low = bits / 32;
+            limbs.push_back(0);
+            for (std::size_t k = limbs.size(); k-- > low + 1;)
+                limbs[k] = (limbs[k] << shift) | (limbs[k - 1] >> (32 - shift));
+            limbs[low] <<= shift;
+        }
+        trim();
+    }
+
+    // Shifts the magnitude, so rounds toward zero.
+    void shift_right(std::size_t bits)
+    {
+        if (bits / 32 >= limbs.size())
+        {
+            *this = {};
+            return;
+        }
+        limbs.erase(limbs.begin(), limbs.begin() + std::ptrdiff_t(bits / 32));
+        if (const unsigned shift = unsigned(bits % 32); shift != 0)
+        {
+            for (std::size_t k = 0; k + 1 < limbs.size(); ++k)
+                limbs[k] = (limbs[k] >> shift) | (limbs[k + 1] << (32 - shift));
+            limbs.back() >>= shift;
+        }
+        trim();
+    }
+
+    // magnitude = magnitude * factor + addend
+    void multiply_add(std::uint32_t factor, std::uint32_t addend)
+    {
+        std::uint64_t carry = addend;
+        for (std::uint32_t &limb : limbs)
+        {
+            carry += std::uint64_t(limb) * factor;
+            limb = std::uint32_t(carry);
+            carry >>= 32;
+        }
+        if (carry != 0)
+            limbs.push_back(std::uint32_t(carry));
+        trim();
+    }
+
+    // magnitude /= divisor; returns the remainder.
+    std::uint32_t divide(std::uint32_t divisor)
+    {
+        std::uint64_t remainder = 0;
+        for (std::size_t k = limbs.size(); k-- != 0;)
+        {
+            const std::uint64_t dividend = (remainder << 32) | limbs[k];
+            limbs[k] = std::uint32_t(dividend / divisor);
+            remainder = dividend % divisor;
+        }
+        trim();
+        return std::uint32_t(remainder);
+    }
+
+    friend int compare(const bigint &a, const bigint &b)
+    {
+        if (a.negative != b.negative)
+            return a.negative ? -1 : 1;
+        const int magnitude = compare_magnitude(a, b);
+        return a.negative ? -magnitude : magnitude;
+    }
+
+    friend bool operator==(const bigint &a, const bigint &b) = default;
+};
+
+// An exact value: mantissa * 2^exponent, or an infinity or NaN.
+struct exact_value
+{
+    bool nan = false;
+    int infinity = 0; // +1 or -1 for an infinity.
+    bigint mantissa;
+    long exponent = 0;
+};
+
+template <class T> exact_value exact(T v)
+{
+    exact_value x;
+    if constexpr (std::floating_point<T>)
+    {
+        if (v != v)
+            x.nan = true;
+        else if (v == std::numeric_limits<T>::infinity() || v == -std::numeric_limits<T>::infinity())
+            x.infinity = v > 0 ? 1 : -1;
+        else
+        {
+            // frexp and ldexp are exact; the scaled fraction is an integer of at most digits bits,
+            // taken apart 32 bits at a time by exact fmod.
+            int e = 0;
+            T m = std::ldexp(std::frexp(v, &e), std::numeric_limits<T>::digits);
+            x.exponent = long(e) - std::numeric_limits<T>::digits;
+            const bool negative = m < 0;
+            m = std::fabs(m);
+            std::vector<std::uint32_t> parts;
+            while (m != 0)
+            {
+                const T part = std::fmod(m, T(4294967296.0));
+                parts.push_back(std::uint32_t(part));
+                m = (m - part) / T(4294967296.0);
+            }
+            for (std::size_t k = parts.size(); k-- != 0;)
+            {
+                x.mantissa.shift_left(32);
+                x.mantissa.multiply_add(1, parts[k]);
+            }
+            if (negative)
+                x.mantissa.negate();
+        }
+    }
+    else
+        x.mantissa = bigint::of(v);
+    return x;
+}
+
+// Compares finite values.
+inline int compare(const exact_value &a, const exact_value &b)
+{
+    const long exponent = std::min(a.exponent, b.exponent);
+    bigint x = a.mantissa, y = b.mantissa;
+    x.shift_left(std::size_t(a.exponent - exponent));
+    y.shift_left(std::size_t(b.exponent - exponent));
+    return compare(x, y);
+}
+
+// The outcome of checking s against the range of Dst, [lowest(), max()].
+template <class Dst, class Src> in_range_ext::range_outcome reference_outcome(Src s)
+{
+    const exact_value x = exact(s);
+    if (x.nan)
+        return in_range_ext::range_outcome::nan;
+    if (x.infinity != 0)
+        return x.infinity > 0 ? in_range_ext::range_outcome::above : in_range_ext::range_outcome::below;
+    if (compare(x, exact(std::numeric_limits<Dst>::lowest())) < 0)
+        return in_range_ext::range_outcome::below;
+    if (compare(x, exact(std::numeric_limits<Dst>::max())) > 0)
+        return in_range_ext::range_outcome::above;
+    return in_range_ext::range_outcome::in_range;
+}
+
+template <class Dst, class Src> bool reference_in_range(Src s)
+{
+    return reference_outcome<Dst>(s) == in_range_ext::range_outcome::in_range;
+}
+
+// The finite value s rounded toward zero, as an integer.
+template <class Src> bigint truncated(Src s)
+{
+    const exact_value x = exact(s);
+    bigint t = x.mantissa;
+    if (x.exponent >= 0)
+        t.shift_left(std::size_t(x.exponent));
+    else
+        t.shift_right(std::size_t(-x.exponent));
+    return t;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Types.
+
+template <class... T> struct type_list
+{
+};
+
+using tested_types = type_list<std::int8_t, std::uint8_t, std::int16_t, std::uint16_t, std::int32_t, std::uint32_t, std::int64_t, std::uint64_t, float,
+                               double, long double>;
+using tested_integer_types = type_list<std::int8_t, std::uint8_t, std::int16_t, std::uint16_t, std::int32_t, std::uint32_t, std::int64_t, std::uint64_t>;
+
+// Calls f.template operator()<T>() for the T at position index (modulo the number of types).
+template <class... T, class F> void visit_type(type_list<T...>, std::size_t index, F &&f)
+{
+    index %= sizeof...(T);
+    std::size_t k = 0;
+    ((k++ == index ? (f.template operator()<T>(), 0) : 0), ...);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Input.
+
+// Takes values from the fuzzer's input; once it runs out, values are zero.
+class fuzz_input
+{
+    const std::uint8_t *data;
+    std::size_t size;
+
+public:
+    fuzz_input(const std::uint8_t *bytes, std::size_t length) : data(bytes), size(length)
+    {
+    }
+
+    std::size_t remaining() const
+    {
+        return size;
+    }
+
+    std::string_view rest()
+    {
+        const std::string_view text(reinterpret_cast<const char *>(data), size);
+        data += size;
+        size = 0;
+        return text;
+    }
+
+    template <class T> T raw()
+    {
+        T value{};
+        const std::size_t n = std::min(sizeof value, size);
+        std::memcpy(&value, data, n);
+        data += n;
+        size -= n;
+        return value;
+    }
+
+    std::uint8_t byte()
+    {
+        return raw<std::uint8_t>();
+    }
+
+    // Either raw bytes or, more often, a value a few steps from one near a boundary of some type,
+    // since random bytes would rarely come close to one.
+    template <class T> T value()
+    {
+        const std::uint8_t mode = byte();
+        if (mode % 4 == 0)
+            return raw<T>();
+        const int steps = int(mode / 4 % 9) - 4;
+        const std::uint8_t which = byte();
+        if constexpr (std::floating_point<T>)
+        {
+            constexpr long double limits[] = {0,
+                                              1,
+                                              0.5L,
+                                              0x1p7L,
+                                              0x1p8L,
+                                              0x1p15L,
+                                              0x1p16L,
+                                              0x1p24L,
+                                              0x1p31L,
+                                              0x1p32L,
+                                              0x1p53L,
+                                              0x1p63L,
+                                              0x1p64L,
+                                              std::numeric_limits<float>::max(),
+                                              std::numeric_limits<double>::max(),
+                                              std::numeric_limits<long double>::max(),
+                                              std::numeric_limits<float>::denorm_min(),
+                                              std::numeric_limits<long double>::infinity()};
+            long double start = limits[which / 2 % std::size(limits)];
+            start = which % 2 ? -start : start;
+            if (std::isfinite(start))
+                start = std::clamp(start, (long double)std::numeric_limits<T>::lowest(), (long double)std::numeric_limits<T>::max());
+            T v = T(start);
+            for (int k = 0; k < std::abs(steps); ++k)
+                v = std::nextafter(v, steps < 0 ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity());
+            return v;
+        }
+        else
+        {
+            constexpr std::uintmax_t limits[] = {0,
+                                                 1,
+                                                 std::uintmax_t(1) << 7,
+                                                 std::uintmax_t(1) << 8,
+                                                 std::uintmax_t(1) << 15,
+                                                 std::uintmax_t(1) << 16,
+                                                 std::uintmax_t(1) << 24,
+                                                 std::uintmax_t(1) << 31,
+                                                 std::uintmax_t(1) << 32,
+                                                 std::uintmax_t(1) << 53,
+                                                 std::uintmax_t(1) << 63,
+                                                 0xffffff8000000000, // Largest float below 2^64.
+                                                 0xfffffffffffff800, // Largest double below 2^64.
+                                                 0x7fffff8000000000, // Largest float below 2^63.
+                                                 0x7ffffffffffffc00}; // Largest double below 2^63.
+            std::uintmax_t start = limits[which / 2 % std::size(limits)];
+            start = which % 2 ? std::uintmax_t(0) - start : start;
+            return T(start + std::uintmax_t(std::intmax_t(steps))); // Converted modulo 2^N.
+        }
+    }
+};
+
+// -------------------------------------------------------------------------------------------------
+// Reporting.
+
+inline void print_value(const char *name, long double v)
+{
+    std::fprintf(stderr, "  %s = %La (%Lg)\n", name, v, v);
+}
+
+template <std::integral I> void print_value(const char *name, I v)
+{
+    if constexpr (std::is_signed_v<I>)
+        std::fprintf(stderr, "  %s = %jd\n", name, std::intmax_t(v));
+    else
+        std::fprintf(stderr, "  %s = %ju\n", name, std::uintmax_t(v));
+}
+
+template <class Dst, class Src> [[noreturn]] void mismatch(const char *what, Src s)
+{
+    std::fprintf(stderr, "mismatch: %s (dst %zu bytes, %s; src %zu bytes, %s)\n", what, sizeof(Dst),
+                 std::floating_point<Dst> ? "floating" : "integer", sizeof(Src), std::floating_point<Src> ? "floating" : "integer");
+    if constexpr (std::floating_point<Src>)
+        print_value("src", (long double)s);
+    else
+        print_value("src", s);
+    std::abort();
+}
+} // namespace in_range_ext_fuzz
+
+#endif // IN_RANGE_EXT_FUZZ_REFERENCE_H
@@ -0,0 +1,98 @@
+//
+// Driver for building the fuzz targets without libFuzzer (e.g. with GCC). Each file named on the
+// command line is run as one input; with no files, random inputs are run instead:
+//
+//   -runs=N     number of random inputs (default 1000000)
+//   -max_len=N  maximum input length in bytes (default 64)
+//   -seed=N     random seed (default 1)
+//
+// Like libFuzzer, it reports executions per second when done.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size);
+
+int main(int argc, char **argv)
+{
+    std::size_t runs = 1000000, max_len = 64;
+    std::uint64_t seed = 1;
+    std::vector<const char *> files;
+    for (int k = 1; k < argc; ++k)
+    {
+        if (std::strncmp(argv[k], "-runs=", 6) == 0)
+            runs = std::strtoull(argv[k] + 6, nullptr, 10);
+        else if (std::strncmp(argv[k], "-max_len=", 9) == 0)
+            max_len = std::strtoull(argv[k] + 9, nullptr, 10);
+        else if (std::strncmp(argv[k], "-seed=", 6) == 0)
+            seed = std::strtoull(argv[k] + 6, nullptr, 10);
+        else if (argv[k][0] != '-')
+            files.push_back(argv[k]);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t executions = 0;
+    if (!files.empty())
+        for (const char *file : files)
+        {
+            std::ifstream in(file, std::ios::binary);
+            if (!in)
+            {
+                std::fprintf(stderr, "cannot read %s\n", file);
+                return 1;
+            }
+            const std::vector<std::uint8_t> input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+            ++executions;
+        }
+    else
+    {
+        std::mt19937_64 random(seed);
+        std::vector<std::uint8_t> input;
+        for (; executions < runs; ++executions)
+        {
+            input.resize(random() % (max_len + 1));
+            for (std::uint8_t &byte : input)
+                byte = std::uint8_t(random());
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("#%zu\tDONE\texec/s: %.0f\n", executions, seconds > 0 ? double(executions) / seconds : 0.0);
+    return 0;
+}
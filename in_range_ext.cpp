@@ -1,4 +1,9 @@
 #include "in_range_ext.h"
+#include "in_range_ext_arrow.h"
+#include "in_range_ext_coro.h"
+#include "in_range_ext_parallel.h"
+#include "in_range_ext_trace.h"
+#include "in_range_ext_uring.h"
 
 bool in_int_range(float f);
 bool in_int_range(float f)
@@ -44,6 +49,12 @@ int main()
     IN_RANGE_EXT_ASSERT(float(dfloat(-(fradix - 1))) == -(fradix - 1));
     IN_RANGE_EXT_ASSERT(float(dfloat(+(fradix - 1))) == +(fradix - 1));
 
+    // All pairs share one decomp per radix; integers are truncated to the precision asked for.
+    static_assert(std::is_same_v<in_range_ext::detail::range_bounds<int8_t, float>::fdecomp, in_range_ext::detail::range_bounds<double, uint64_t>::fdecomp>);
+    static_assert(std::is_same_v<in_range_ext::detail::range_bounds<int8_t, float>::fdecomp, in_range_ext::detail::range_bounds<float, long double>::fdecomp>);
+    if constexpr (flimits::radix == 2 && flimits::digits == 24)
+        static_assert(float(in_range_ext::detail::shared_decomp<2, 24>(0x7fffffff, 24)) == 0x7fffff80);
+
     if constexpr (flimits::radix == 2 && flimits::digits == 24)
     {
         static_assert(int32_t(float(INT32_MIN)) == INT32_MIN);
@@ -58,5 +69,515 @@ int main()
         IN_RANGE_EXT_ASSERT(!in_range_ext::in_range<int32_t>(flimits::max()));
         IN_RANGE_EXT_ASSERT(!in_range_ext::in_range<int32_t>(+flimits::infinity()));
         IN_RANGE_EXT_ASSERT(!in_range_ext::in_range<int32_t>(+flimits::quiet_NaN()));
+
+        // Batch forms.
+        const float values[] = {-flimits::quiet_NaN(), float(INT32_MIN), 0.0f, float(0x7fffff80), float(INT32_MAX), flimits::infinity()};
+        const bool expected[] = {false, true, true, true, false, false};
+        constexpr std::size_t num_values = std::size(values);
+
+        bool mask[num_values] = {};
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range<int32_t>(std::span<const float>(values), std::span<bool>(mask)) == 3);
+        IN_RANGE_EXT_ASSERT(std::equal(mask, mask + num_values, expected));
+
+        // Column embedded in an array of structs, written to a strided mask.
+        struct record
+        {
+            float value;
+            int tag;
+        };
+        static_assert(sizeof(record) == 2 * sizeof(float));
+        record records[num_values] = {};
+        for (std::size_t k = 0; k < num_values; ++k)
+            records[k].value = values[k];
+        bool strided_mask[2 * num_values] = {};
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range_strided<int32_t>(&records[0].value, 2, num_values, strided_mask, 2) == 3);
+        for (std::size_t k = 0; k < num_values; ++k)
+            IN_RANGE_EXT_ASSERT(strided_mask[2 * k] == expected[k] && !strided_mask[2 * k + 1]);
+
+#if defined __cpp_lib_mdspan && __cpp_lib_mdspan >= 202207L
+        // The values as a 2 x 3 matrix: contiguous, into a column-major mask, and its 2 x 2 right block.
+        using extents = std::dextents<std::size_t, 2>;
+        const std::mdspan<const float, extents> matrix(values, 2, 3);
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range<int32_t>(matrix, std::mdspan<bool, extents>(mask, 2, 3)) == 3);
+        IN_RANGE_EXT_ASSERT(std::equal(mask, mask + num_values, expected));
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range<int32_t>(matrix, std::mdspan<bool, extents, std::layout_left>(mask, 2, 3)) == 3);
+        for (std::size_t i = 0; i < 2; ++i)
+            for (std::size_t j = 0; j < 3; ++j)
+                IN_RANGE_EXT_ASSERT(mask[i + 2 * j] == expected[3 * i + j]);
+        const std::layout_stride::mapping<extents> block(extents(2, 2), std::array<std::size_t, 2>{3, 1});
+        bool block_mask[4] = {};
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range<int32_t>(std::mdspan<const float, extents, std::layout_stride>(values + 1, block),
+                                                            std::mdspan<bool, extents>(block_mask, 2, 2)) == 2);
+        for (std::size_t i = 0; i < 2; ++i)
+            for (std::size_t j = 0; j < 2; ++j)
+                IN_RANGE_EXT_ASSERT(block_mask[2 * i + j] == expected[3 * i + 1 + j]);
+#endif
+
+        // Nullable: validity bits 1..6 of 0b01010110 mark elements 0, 1, 3 and 5 non-null.
+        const std::uint8_t validity[] = {0b01010110};
+        std::uint8_t bitmap[1] = {0xff};
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range<int32_t>(std::span<const float>(values), validity, 1, bitmap) == 2);
+        IN_RANGE_EXT_ASSERT(bitmap[0] == 0b001010);
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range<int32_t>(std::span<const float>(values), validity, 1, std::span<bool>(mask)) == 2);
+        IN_RANGE_EXT_ASSERT(!mask[0] && mask[1] && !mask[2] && mask[3] && !mask[4] && !mask[5]);
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range<int32_t>(std::span<const float>(values), nullptr, 0, bitmap) == 3);
+        IN_RANGE_EXT_ASSERT(bitmap[0] == 0b001110);
+
+        // Runtime bounds: 2^24 + 1 and 2^24 + 3 are not floats, so [2^24 + 1, 2^24 + 3] holds only 2^24 + 2.
+        using in_range_ext::compiled_bounds;
+        static_assert(compiled_bounds<float>(16777217, 16777219).min_in_range == 16777218.0f);
+        static_assert(compiled_bounds<float>(16777217, 16777219).max_in_range == 16777218.0f);
+        static_assert(compiled_bounds<float>(-16777219, -16777217).min_in_range == -16777218.0f);
+        static_assert(compiled_bounds<float>(-16777219, -16777217).max_in_range == -16777218.0f);
+        static_assert(compiled_bounds<float>(INT64_MIN, INT64_MAX).min_in_range == in_range_ext::detail::range_bounds<int64_t, float>::min_in_range);
+        static_assert(compiled_bounds<float>(INT64_MIN, INT64_MAX).max_in_range == in_range_ext::detail::range_bounds<int64_t, float>::max_in_range);
+        static_assert(!in_range_ext::in_range_bounds(16777216.0f, 16777217, 16777217)); // No float in the interval.
+        static_assert(!in_range_ext::in_range_bounds(0.0, 1, 0));
+        static_assert(in_range_ext::in_range_bounds(1e12, 0LL, 1'000'000'000'000LL) && !in_range_ext::in_range_bounds(1e12 + 1, 0LL, 1'000'000'000'000LL));
+        static_assert(in_range_ext::in_range<0, 65535>(65535.0) && !in_range_ext::in_range<0, 65535>(65535.5) && !in_range_ext::in_range<0, 65535>(-0.5));
+        static_assert(in_range_ext::in_range<-16777219, 16777219LL>(-16777218.0f) && !in_range_ext::in_range<-16777217, 16777217U>(16777218.0f));
+        static_assert(!in_range_ext::in_range<0, UINT64_MAX>(0x1p64f) && in_range_ext::in_range<0, UINT64_MAX>(0x1p64f - 0x1p40f));
+        constexpr compiled_bounds<float> near_limit(0, 0x7fffff7f);
+        IN_RANGE_EXT_ASSERT(near_limit.max_in_range == 0x7fffff00 && !in_range_ext::in_range_bounds(float(0x7fffff80), near_limit));
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range_bounds(std::span<const float>(values), compiled_bounds<float>(0, INT32_MAX), std::span<bool>(mask)) == 2);
+        IN_RANGE_EXT_ASSERT(!mask[1] && mask[2] && mask[3] && !mask[4]);
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range_bounds(std::span<const float>(values), compiled_bounds<float>(INT32_MIN, 0), validity, 1, bitmap) == 1);
+        IN_RANGE_EXT_ASSERT(bitmap[0] == 0b000010);
+
+        // Arrow C Data Interface, sliced by one element.
+        const double column[] = {0.0, -1.0, 1e10, 32767.0, 32768.0};
+        const std::uint8_t column_validity[] = {0b11011};
+        const void *column_buffers[] = {column_validity, column};
+        ArrowSchema schema{};
+        schema.format = "g";
+        ArrowArray array{};
+        array.length = 4;
+        array.null_count = 1;
+        array.offset = 1;
+        array.n_buffers = 2;
+        array.buffers = column_buffers;
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range_arrow<int16_t>(schema, array, bitmap) == 2);
+        IN_RANGE_EXT_ASSERT(bitmap[0] == 0b0101);
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range_arrow<float>(schema, array, bitmap) == 3);
+        bool rejected = false;
+        schema.format = "u";
+        try
+        {
+            in_range_ext::in_range_arrow<int16_t>(schema, array, bitmap);
+        }
+        catch (const std::invalid_argument &)
+        {
+            rejected = true;
+        }
+        IN_RANGE_EXT_ASSERT(rejected);
+
+        // Dictionary- and run-length-encoded columns. Index 99 is in a null row.
+        const int16_t indices[] = {2, 0, 99, 1, 2, 3};
+        bool dict_mask[std::size(indices)] = {};
+        const std::uint8_t index_validity[] = {0b111011};
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range_dict<int16_t>(std::span<const double>(column), std::span<const int16_t>(indices).subspan(3),
+                                                                 std::span<bool>(dict_mask)) == 2);
+        IN_RANGE_EXT_ASSERT(dict_mask[0] && !dict_mask[1] && dict_mask[2]);
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range_dict<int16_t>(std::span<const double>(column), std::span<const int16_t>(indices), index_validity, 0,
+                                                                 bitmap) == 3);
+        IN_RANGE_EXT_ASSERT(bitmap[0] == 0b101010);
+
+        const uint8_t run_lengths[] = {2, 0, 3};
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range_rle<int16_t>(std::span<const double>(column).first(3), std::span<const uint8_t>(run_lengths),
+                                                                std::span<bool>(dict_mask)) == 2);
+        IN_RANGE_EXT_ASSERT(dict_mask[0] && dict_mask[1] && !dict_mask[2] && !dict_mask[3] && !dict_mask[4]);
+
+        // Dictionary-encoded Arrow array: the earlier array is the dictionary.
+        const void *index_buffers[] = {index_validity, indices};
+        ArrowSchema index_schema{};
+        index_schema.format = "s";
+        index_schema.dictionary = &schema;
+        schema.format = "g";
+        ArrowArray index_array{};
+        index_array.length = 5;
+        index_array.null_count = 1;
+        index_array.offset = 1;
+        index_array.n_buffers = 2;
+        index_array.buffers = index_buffers;
+        index_array.dictionary = &array;
+        IN_RANGE_EXT_ASSERT(in_range_ext::in_range_arrow<int16_t>(index_schema, index_array, bitmap) == 2);
+        IN_RANGE_EXT_ASSERT(bitmap[0] == 0b01001);
+        index_array.offset = 0; // Index 99 in a valid row.
+        index_array.null_count = 0;
+        index_buffers[0] = nullptr;
+        rejected = false;
+        try
+        {
+            in_range_ext::in_range_arrow<int16_t>(index_schema, index_array, bitmap);
+        }
+        catch (const std::invalid_argument &)
+        {
+            rejected = true;
+        }
+        IN_RANGE_EXT_ASSERT(rejected);
+
+        // Streaming validation, one value per chunk and then all at once.
+        in_range_ext::range_validator<int32_t, float> validator;
+        for (const float value : values)
+            validator.feed(std::span<const float>(&value, 1));
+        const in_range_ext::range_stats<float> stats = validator.stats();
+        IN_RANGE_EXT_ASSERT(stats.count == num_values && stats.num_in_range == 3 && stats.num_nan == 1 && stats.num_above == 2 && stats.num_below == 0);
+        IN_RANGE_EXT_ASSERT(stats.min == float(INT32_MIN) && stats.max == flimits::infinity() && stats.first_failure == 0);
+        validator.reset();
+        validator.feed(std::span<const float>(values).subspan(1));
+        IN_RANGE_EXT_ASSERT(validator.stats().first_failure == 3);
+        IN_RANGE_EXT_ASSERT(in_range_ext::range_outcome_of<int32_t>(values[0]) == in_range_ext::range_outcome::nan);
+        IN_RANGE_EXT_ASSERT(in_range_ext::range_outcome_of<int32_t>(-values[4]) == in_range_ext::range_outcome::in_range);
+        IN_RANGE_EXT_ASSERT(in_range_ext::range_outcome_of<int32_t>(-values[5]) == in_range_ext::range_outcome::below);
+
+        // Coroutine validation of a source yielding chunks of 1 and 2 values, the larger on a pool. The
+        // source completes each next() on its own event loop, here a one-thread pool, and the
+        // coroutine must come back to it after each offloaded chunk.
+        struct chunk_source
+        {
+            std::span<const float> remaining;
+            in_range_ext::worker_pool &loop;
+            std::size_t chunks = 0;
+            std::vector<std::thread::id> callers;
+            auto next()
+            {
+                callers.push_back(std::this_thread::get_id());
+                std::optional<std::span<const float>> chunk;
+                if (!remaining.empty())
+                {
+                    chunk = remaining.first(std::min<std::size_t>(remaining.size(), 1 + chunks++ % 2));
+                    remaining = remaining.subspan(chunk->size());
+                }
+                return loop_chunk{loop, chunk};
+            }
+            struct loop_chunk
+            {
+                in_range_ext::worker_pool &loop;
+                std::optional<std::span<const float>> chunk;
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+                void await_suspend(std::coroutine_handle<> h) const
+                {
+                    loop.post([h] { h.resume(); });
+                }
+                std::optional<std::span<const float>> await_resume() const noexcept
+                {
+                    return chunk;
+                }
+            };
+        };
+        {
+            in_range_ext::worker_pool pool(2), loop(1);
+            std::thread::id loop_thread;
+            std::binary_semaphore started(0);
+            loop.post([&] {
+                loop_thread = std::this_thread::get_id();
+                started.release();
+            });
+            started.acquire();
+            chunk_source source{values, loop, 0, {}};
+            const auto result = in_range_ext::sync_wait(in_range_ext::validate_async<int32_t, float>(source, &pool, &loop, 2));
+            IN_RANGE_EXT_ASSERT(result.chunks == 4 && result.offloaded_chunks == 2);
+            IN_RANGE_EXT_ASSERT(result.stats.count == num_values && result.stats.num_in_range == 3 && result.stats.num_nan == 1);
+            IN_RANGE_EXT_ASSERT(source.callers.size() == 5 && std::all_of(source.callers.begin() + 1, source.callers.end(), [&](std::thread::id id) { return id == loop_thread; }));
+        }
+
+        // Parallel validation in chunks of two values agrees with the sequential validator.
+        {
+            std::vector<float> repeated;
+            for (int r = 0; r < 100; ++r)
+                repeated.insert(repeated.end(), values + 1, values + num_values);
+            in_range_ext::range_validator<int32_t, float> sequential;
+            sequential.feed(repeated);
+            const auto parallel = in_range_ext::parallel_validate<int32_t>(std::span<const float>(repeated), {.num_threads = 4, .chunk_bytes = 8});
+            IN_RANGE_EXT_ASSERT(parallel.count == sequential.stats().count && parallel.num_in_range == sequential.stats().num_in_range);
+            IN_RANGE_EXT_ASSERT(parallel.num_above == sequential.stats().num_above && parallel.first_failure == sequential.stats().first_failure);
+            IN_RANGE_EXT_ASSERT(parallel.min == sequential.stats().min && parallel.max == sequential.stats().max);
+            IN_RANGE_EXT_ASSERT(in_range_ext::detail::parse_cpu_list("0-2,5,7-8") == std::vector<int>({0, 1, 2, 5, 7, 8}));
+        }
+
+#ifdef IN_RANGE_EXT_INSTRUMENTATION
+        // Instrumentation counts each outcome at this call site, including those of exited threads.
+        {
+            const std::uint_least32_t line = __LINE__ + 1;
+            const auto check_all = [&] { for (const float v : values) (void)in_range_ext::in_range<int32_t>(v); };
+            check_all();
+            std::thread(check_all).join();
+            const auto sites = in_range_ext::instrumentation_snapshot();
+            const auto site = std::find_if(sites.begin(), sites.end(), [&](const auto &s) { return s.line == line; });
+            IN_RANGE_EXT_ASSERT(site != sites.end() && site->file.ends_with("in_range_ext.cpp"));
+            IN_RANGE_EXT_ASSERT(site->counts == (std::array<std::uint64_t, 4>{6, 2, 4, 0}));
+
+            // The library's own checks, such as those of in_range_rle above, are not counted under its lines.
+            IN_RANGE_EXT_ASSERT(std::none_of(sites.begin(), sites.end(), [](const auto &s) { return s.file.ends_with("in_range_ext.h"); }));
+        }
+#endif
+
+#ifdef IN_RANGE_EXT_TRACE
+        // The tracer samples failures only, keeping the first ones while its reservoir fills.
+        {
+            std::vector<in_range_ext::failure_record> captured;
+            in_range_ext::failure_tracer tracer([&](const in_range_ext::failure_record &r) { captured.push_back(r); }, {.sample_size = 2});
+            const std::uint_least32_t line = __LINE__ + 2;
+            for (int pass = 0; pass < 100; ++pass)
+                for (const float v : values) (void)in_range_ext::in_range<int32_t>(v);
+            tracer.flush();
+            IN_RANGE_EXT_ASSERT(captured.size() >= 2 && tracer.sample().size() == 2 && tracer.dropped() == 0);
+            IN_RANGE_EXT_ASSERT(captured[0].outcome == in_range_ext::range_outcome::nan && std::isnan(std::get<long double>(captured[0].value)));
+            IN_RANGE_EXT_ASSERT(captured[1].outcome == in_range_ext::range_outcome::above && std::get<long double>(captured[1].value) == 0x1p31L);
+            IN_RANGE_EXT_ASSERT(captured[1].site.line() == line && std::string_view(captured[1].dst_type) == "int");
+            IN_RANGE_EXT_ASSERT(std::string_view(captured[1].src_type) == "float");
+        }
+#endif
+
+#ifdef IN_RANGE_EXT_HAS_URING
+        // io_uring file validation, with buffers smaller than the file and a partial trailing value.
+        char path[] = "/tmp/in_range_ext_XXXXXX";
+        const int fd = mkstemp(path);
+        IN_RANGE_EXT_ASSERT(fd >= 0);
+        IN_RANGE_EXT_ASSERT(write(fd, values, sizeof values) == ssize_t(sizeof values) && write(fd, "x", 1) == 1);
+        close(fd);
+        for (const std::size_t buffer_size : {std::size_t(8), std::size_t(4096)})
+        {
+            const auto file = in_range_ext::validate_file<int32_t, float>(path, {.buffer_size = buffer_size, .queue_depth = 3});
+            IN_RANGE_EXT_ASSERT(file.bytes == sizeof values + 1 && file.trailing_bytes == 1);
+            IN_RANGE_EXT_ASSERT(file.values.count == num_values && file.values.num_in_range == 3 && file.values.first_failure == 0);
+        }
+        // O_DIRECT rounds the last read up to a whole block; skipped where the file system refuses it.
+        if (const int direct_fd = open(path, O_RDONLY | O_DIRECT); direct_fd >= 0)
+        {
+            close(direct_fd);
+            const auto file = in_range_ext::validate_file<int32_t, float>(path, {.buffer_size = 4096, .queue_depth = 3, .direct_io = true});
+            IN_RANGE_EXT_ASSERT(file.bytes == sizeof values + 1 && file.trailing_bytes == 1);
+            IN_RANGE_EXT_ASSERT(file.values.count == num_values && file.values.num_in_range == 3 && file.values.first_failure == 0);
+        }
+        unlink(path);
+#endif
+    }
+
+    // Frame-of-reference blocks: deltas {0, 767, 768, 1023} packed in 10 bits each from base 32000.
+    using in_range_ext::block_range;
+    static_assert(in_range_ext::classify_for_block<int16_t>(int64_t(0), 15) == block_range::all_in);
+    static_assert(in_range_ext::classify_for_block<int16_t>(int64_t(0), 16) == block_range::mixed);
+    static_assert(in_range_ext::classify_for_block<int16_t>(int64_t(40000), 4) == block_range::all_out);
+    static_assert(in_range_ext::classify_for_block<int16_t>(INT64_MAX - 1, 1) == block_range::all_out);
+    static_assert(in_range_ext::classify_for_block<int16_t>(INT64_MAX - 1, 2) == block_range::mixed); // Wraps to INT64_MIN.
+    static_assert(in_range_ext::classify_for_block<float>(INT64_MIN, 64) == block_range::all_in);
+
+    const std::uint8_t packed[] = {0x00, 0xfc, 0x0b, 0xf0, 0xff};
+    const in_range_ext::for_block<int64_t> blocks[] = {{.base = 0, .bit_width = 10, .count = 4, .packed = packed},
+                                                       {.base = 32000, .bit_width = 10, .count = 4, .packed = packed}};
+    bool for_mask[4] = {};
+    IN_RANGE_EXT_ASSERT(in_range_ext::in_range_for<int16_t>(blocks[1], std::span<bool>(for_mask)) == 2);
+    IN_RANGE_EXT_ASSERT(for_mask[0] && for_mask[1] && !for_mask[2] && !for_mask[3]);
+    IN_RANGE_EXT_ASSERT(in_range_ext::all_in_range_for<int16_t>(std::span<const in_range_ext::for_block<int64_t>>(blocks).first(1)));
+    IN_RANGE_EXT_ASSERT(!in_range_ext::all_in_range_for<int16_t>(std::span<const in_range_ext::for_block<int64_t>>(blocks)));
+
+    // numeric_cast policies.
+    using in_range_ext::numeric_cast;
+    using in_range_ext::range_outcome;
+    using in_range_ext::saturate_on_failure;
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    static_assert(numeric_cast<int8_t, saturate_on_failure>(-1.5) == -1);
+    static_assert(numeric_cast<int8_t, saturate_on_failure>(300.0) == 127 && numeric_cast<int8_t, saturate_on_failure>(-inf) == -128);
+    static_assert(numeric_cast<int8_t, saturate_on_failure>(std::numeric_limits<double>::quiet_NaN()) == 0);
+    static_assert(numeric_cast<uint8_t, saturate_on_failure>(-1) == 0 && numeric_cast<uint8_t, saturate_on_failure>(256u) == 255);
+    static_assert(numeric_cast<float, saturate_on_failure>(1e300) == FLT_MAX && numeric_cast<float, saturate_on_failure>(-inf) == -HUGE_VALF);
+    static_assert(numeric_cast<int, in_range_ext::call_on_failure<[](double, range_outcome o) { return o == range_outcome::nan ? -1 : -2; }>>(1e10) == -2);
+
+    bool threw = false;
+    try
+    {
+        (void)numeric_cast<int16_t>(40000.0f);
+    }
+    catch (const in_range_ext::bad_numeric_cast &e)
+    {
+        threw = e.outcome() == range_outcome::above;
+    }
+    IN_RANGE_EXT_ASSERT(threw && numeric_cast<int16_t>(-32768.0f) == -32768);
+
+    errno = 0;
+    IN_RANGE_EXT_ASSERT((numeric_cast<int32_t, in_range_ext::errno_on_failure>(-3e9) == INT32_MIN && errno == ERANGE));
+    IN_RANGE_EXT_ASSERT((std::isnan(numeric_cast<float, in_range_ext::errno_on_failure>(std::nan(""))) && errno == EDOM));
+
+    // Fixed point: Q15 covers [-1, 1 - 2^-15]; Q31's upper bound is the float below 1, not 1 - 2^-31.
+    using q15 = in_range_ext::fixed_point<int16_t, 15>;
+    using q31 = in_range_ext::fixed_point<int32_t, 31>;
+    static_assert(in_range_ext::in_range<q15>(-1.0f) && in_range_ext::in_range<q15>(1.0f - 0x1p-15f) && !in_range_ext::in_range<q15>(1.0f - 0x1p-16f));
+    static_assert(!in_range_ext::in_range<q15>(std::nextafter(-1.0, -2.0)));
+    static_assert(in_range_ext::detail::range_bounds<q31, float>::max_in_range == 1.0f - 0x1p-24f && !in_range_ext::in_range<q31>(1.0f));
+    static_assert(in_range_ext::in_range<q31>(1.0 - 0x1p-31) && !in_range_ext::in_range<q31>(1.0 - 0x1p-32));
+    static_assert(numeric_cast<q15>(0.5f).raw == 0x4000 && numeric_cast<q15, saturate_on_failure>(2.0).raw == INT16_MAX);
+    static_assert(numeric_cast<q15, saturate_on_failure>(-inf) == std::numeric_limits<q15>::lowest() && float(q15::from_raw(-0x4000)) == -0.5f);
+    static_assert(std::numeric_limits<q15>::is_signed && !std::numeric_limits<q15>::is_integer && std::numeric_limits<q15>::digits == 15);
+    static_assert(std::numeric_limits<q15>::epsilon() == q15::from_raw(1) && std::numeric_limits<q15>::max() == q15::from_raw(INT16_MAX));
+    const float samples[] = {0.25f, -1.5f, std::nanf(""), 1.0f, -1.0f};
+    q31 converted[std::size(samples)];
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_saturating(std::span<const float>(samples), std::span<q31>(converted)) == 3);
+    IN_RANGE_EXT_ASSERT(converted[0].raw == 0x20000000 && converted[1].raw == INT32_MIN && converted[2].raw == 0 && converted[3].raw == INT32_MAX &&
+                        converted[4].raw == INT32_MIN);
+    int16_t converted16[std::size(samples)];
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_saturating(std::span<const float>(samples), std::span<int16_t>(converted16)) == 1);
+    IN_RANGE_EXT_ASSERT(converted16[0] == 0 && converted16[1] == -1 && converted16[2] == 0 && converted16[3] == 1);
+
+    // Checked conversion; converting first must still tell INT32_MIN itself from failures.
+    const double wide_values[] = {-2147483648.0, -2147483649.0, 2147483647.9, 2147483648.0, std::nan(""), -0.5, 1e300, 42.9, -7.5, 3.0, -2147483648.5};
+    int32_t checked[std::size(wide_values)], optimistic[std::size(wide_values)];
+    bool checked_mask[std::size(wide_values)], optimistic_mask[std::size(wide_values)];
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_checked(std::span<const double>(wide_values), std::span<int32_t>(checked), std::span<bool>(checked_mask)) == 5);
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_optimistic(std::span<const double>(wide_values), std::span<int32_t>(optimistic), std::span<bool>(optimistic_mask)) == 5);
+    IN_RANGE_EXT_ASSERT(std::ranges::equal(checked, optimistic) && std::ranges::equal(checked_mask, optimistic_mask));
+    IN_RANGE_EXT_ASSERT(checked[0] == INT32_MIN && checked_mask[0] && checked[1] == 0 && !checked_mask[2] && checked[7] == 42 && checked[8] == -7 && !checked_mask[10]);
+    const float narrow_values[] = {-0x1p31f, 0x1p31f, 1.5f, -1.5f, std::nanf(""), 0x1.fffffep30f, 0.0f, -0x1p63f, 0x1p63f};
+    int64_t checked64[std::size(narrow_values)], optimistic64[std::size(narrow_values)];
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_checked(std::span<const float>(narrow_values), std::span<int64_t>(checked64), std::span<bool>(checked_mask, 9)) == 7);
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_optimistic(std::span<const float>(narrow_values), std::span<int64_t>(optimistic64), std::span<bool>(optimistic_mask, 9)) == 7);
+    IN_RANGE_EXT_ASSERT(std::ranges::equal(checked64, optimistic64) && std::ranges::equal(checked_mask, checked_mask + 9, optimistic_mask, optimistic_mask + 9));
+    IN_RANGE_EXT_ASSERT(checked64[7] == INT64_MIN && checked64[8] == 0 && !checked_mask[4]);
+    int32_t optimistic32[std::size(narrow_values)];
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_optimistic(std::span<const float>(narrow_values), std::span<int32_t>(optimistic32), std::span<bool>(optimistic_mask, 9)) == 5);
+    IN_RANGE_EXT_ASSERT(optimistic32[0] == INT32_MIN && optimistic32[1] == 0 && optimistic32[5] == 0x7fffff80 && optimistic32[7] == 0);
+    int32_t fe32[std::size(narrow_values)];
+    bool fe_mask[std::size(narrow_values)];
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_fe_checked(std::span<const float>(narrow_values), std::span<int32_t>(fe32), std::span<bool>(fe_mask)) == 5);
+    IN_RANGE_EXT_ASSERT(std::ranges::equal(fe32, optimistic32) && std::ranges::equal(fe_mask, fe_mask + 9, optimistic_mask, optimistic_mask + 9));
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_checked(std::span<const double>(wide_values), std::span<int32_t>(checked), std::span<bool>(checked_mask)) == 5);
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_fe_checked(std::span<const double>(wide_values), std::span<int32_t>(optimistic), std::span<bool>(optimistic_mask)) == 5);
+    IN_RANGE_EXT_ASSERT(std::ranges::equal(checked, optimistic) && std::ranges::equal(checked_mask, optimistic_mask));
+
+    // Block by block, leaving the caller's flags as they were.
+    std::vector<float> block_values(10000, -3.75f);
+    block_values[5000] = std::nanf("");
+    block_values[9999] = 0x1p40f;
+    std::vector<int32_t> block_converted(block_values.size());
+    const std::unique_ptr<bool[]> block_mask(new bool[block_values.size()]);
+    std::feclearexcept(FE_ALL_EXCEPT);
+    std::feraiseexcept(FE_DIVBYZERO);
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_fe_checked(std::span<const float>(block_values), std::span<int32_t>(block_converted),
+                                                         std::span<bool>(block_mask.get(), block_values.size())) == 9998);
+    IN_RANGE_EXT_ASSERT(std::fetestexcept(FE_ALL_EXCEPT) == FE_DIVBYZERO);
+    IN_RANGE_EXT_ASSERT(block_converted[4999] == -3 && block_converted[5000] == 0 && !block_mask[5000] && block_mask[5001] && block_converted[9999] == 0);
+    // Also where it falls back to convert_optimistic, for NaN among others.
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_fe_checked(std::span<const double>(wide_values), std::span<int32_t>(optimistic), std::span<bool>(optimistic_mask)) == 5);
+    IN_RANGE_EXT_ASSERT(std::fetestexcept(FE_ALL_EXCEPT) == FE_DIVBYZERO);
+    std::feclearexcept(FE_ALL_EXCEPT);
+
+    // Adaptive conversion, in blocks of 64: clean, clean, half out of range, one out of range, clean.
+    {
+        using in_range_ext::conversion_strategy;
+        constexpr conversion_strategy sparse = in_range_ext::detail::has_indefinite_conversion<int32_t, float> ? conversion_strategy::optimistic : conversion_strategy::checked;
+        constexpr conversion_strategy clean = in_range_ext::detail::exact_invalid_flag<int32_t, float> ? conversion_strategy::fe_flags : sparse;
+        std::vector<float> stream(5 * 64, 12.25f);
+        for (std::size_t k = 128; k < 192; k += 2)
+            stream[k] = 0x1p32f;
+        stream[200] = std::nanf("");
+        std::vector<int32_t> adaptive_converted(stream.size()), checked_converted(stream.size());
+        const std::unique_ptr<bool[]> adaptive_mask(new bool[stream.size()]), checked_mask_stream(new bool[stream.size()]);
+        in_range_ext::adaptive_converter<int32_t, float> converter(64);
+        IN_RANGE_EXT_ASSERT(converter.convert(std::span<const float>(stream).first(256), std::span<int32_t>(adaptive_converted),
+                                              std::span<bool>(adaptive_mask.get(), 256)) == 256 - 33);
+        IN_RANGE_EXT_ASSERT(converter.stats().strategy == sparse);
+        IN_RANGE_EXT_ASSERT(converter.convert(std::span<const float>(stream).subspan(256), std::span<int32_t>(adaptive_converted).subspan(256),
+                                              std::span<bool>(adaptive_mask.get() + 256, 64)) == 64);
+        IN_RANGE_EXT_ASSERT(in_range_ext::convert_checked(std::span<const float>(stream), std::span<int32_t>(checked_converted),
+                                                          std::span<bool>(checked_mask_stream.get(), stream.size())) == stream.size() - 33);
+        IN_RANGE_EXT_ASSERT(adaptive_converted == checked_converted &&
+                            std::equal(adaptive_mask.get(), adaptive_mask.get() + stream.size(), checked_mask_stream.get()));
+        const in_range_ext::conversion_stats &stats = converter.stats();
+        IN_RANGE_EXT_ASSERT(stats.count == stream.size() && stats.num_in_range == stream.size() - 33 && stats.strategy == clean);
+        std::array<std::size_t, 3> expected_blocks = {};
+        for (const conversion_strategy used : {conversion_strategy::checked, clean, clean, conversion_strategy::checked, sparse})
+            ++expected_blocks[std::size_t(used)];
+        IN_RANGE_EXT_ASSERT(stats.blocks == expected_blocks);
+        IN_RANGE_EXT_ASSERT(stats.switches == (clean == conversion_strategy::checked ? 0 : clean == sparse ? 3 : 4));
+        converter.reset();
+        IN_RANGE_EXT_ASSERT(converter.stats().count == 0 && converter.stats().strategy == conversion_strategy::checked);
     }
+
+    // PCM audio: 1.0 clips, and for int32 from float so does everything above 2^31 - 128.
+    const float stereo[] = {1.0f, 1.0f - 0x1p-24f, -1.0f, std::nanf(""), 0.5f / 32768, 1.5f / 32768, 32767.5f / 32768, -32768.5f / 32768};
+    std::size_t clips[2] = {};
+    int32_t pcm32[std::size(stereo)];
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_pcm(std::span<const float>(stereo), 2, std::span<int32_t>(pcm32), clips) == 3);
+    IN_RANGE_EXT_ASSERT(pcm32[0] == INT32_MAX && pcm32[1] == 2147483520 && pcm32[2] == INT32_MIN && pcm32[3] == 0 && clips[0] == 1 && clips[1] == 2);
+    int16_t pcm16[std::size(stereo)];
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_pcm(std::span<const float>(stereo), 2, std::span<int16_t>(pcm16), clips) == 4);
+    IN_RANGE_EXT_ASSERT(pcm16[1] == INT16_MAX && pcm16[4] == 0 && pcm16[5] == 2 && pcm16[6] == INT16_MAX && pcm16[7] == INT16_MIN);
+    IN_RANGE_EXT_ASSERT(clips[0] == 3 && clips[1] == 4);
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_pcm<24>(std::span<const float>(stereo), 2, std::span<int32_t>(pcm32), clips) == 4);
+    IN_RANGE_EXT_ASSERT(pcm32[0] == 0x7fffff && pcm32[1] == 0x7fffff && pcm32[2] == -0x800000 && pcm32[5] == 0x180 && pcm32[7] == -0x800000);
+    const double stereo_double[] = {1.0, 1.0 - 0x1p-53, -1.0, 0.5};
+    int64_t pcm64[std::size(stereo_double)];
+    std::size_t clips64[2] = {};
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_pcm(std::span<const double>(stereo_double), 2, std::span<int64_t>(pcm64), clips64) == 1);
+    IN_RANGE_EXT_ASSERT(pcm64[0] == INT64_MAX && pcm64[1] == INT64_MAX - 1023 && pcm64[2] == INT64_MIN && pcm64[3] == INT64_C(1) << 62 && clips64[0] == 1);
+    std::vector<float> surround(6 * 1000, 0.25f);
+    surround[6 * 700 + 5] = -2.0f;
+    std::vector<int16_t> surround16(surround.size());
+    std::size_t surround_clips[6] = {};
+    IN_RANGE_EXT_ASSERT(in_range_ext::convert_pcm(std::span<const float>(surround), 6, std::span<int16_t>(surround16), surround_clips) == 1);
+    IN_RANGE_EXT_ASSERT(surround_clips[5] == 1 && surround_clips[0] == 0 && surround16[6 * 700 + 5] == INT16_MIN && surround16[0] == 0x2000);
+
+    // Image export: components round to nearest even after scaling by 255, and NaN is the policy's.
+    const float rgba[] = {0.0f, 1.0f, 0.5f, -0.001f, 1.001f, 1.5f / 255, -std::numeric_limits<float>::infinity(), std::nanf("")};
+    uint8_t pixels[std::size(rgba)];
+    const in_range_ext::export_u8_result exported = in_range_ext::export_u8(std::span<const float>(rgba), std::span<uint8_t>(pixels), {.nan_value = 255});
+    IN_RANGE_EXT_ASSERT(exported.clamped == 1 && exported.nan == 1);
+    IN_RANGE_EXT_ASSERT(pixels[0] == 0 && pixels[1] == 255 && pixels[2] == 128 && pixels[3] == 0 && pixels[4] == 255 && pixels[5] == 2 && pixels[6] == 0 &&
+                        pixels[7] == 255);
+
+    // Parsing integers written in floating-point notation, exactly.
+    using in_range_ext::parse_status;
+    using in_range_ext::parse_to_integer;
+    const auto parses_to = [](const auto result, auto value) { return result.status == parse_status::ok && result.value == value; };
+    IN_RANGE_EXT_ASSERT(parses_to(parse_to_integer<int64_t>("-9223372036854775808"), INT64_MIN));
+    IN_RANGE_EXT_ASSERT(parses_to(parse_to_integer<int64_t>("3000000000.0"), int64_t(3000000000)));
+    IN_RANGE_EXT_ASSERT(parses_to(parse_to_integer<int64_t>("1.5e9"), int64_t(1500000000)));
+    IN_RANGE_EXT_ASSERT(parses_to(parse_to_integer<int64_t>("9007199254740993.000"), int64_t(9007199254740993))); // 2^53 + 1
+    IN_RANGE_EXT_ASSERT(parses_to(parse_to_integer<int64_t>("-922337203685477580.8e1"), INT64_MIN));
+    IN_RANGE_EXT_ASSERT(parses_to(parse_to_integer<uint8_t>("+25500e-2"), uint8_t(255)));
+    IN_RANGE_EXT_ASSERT(parses_to(parse_to_integer<uint8_t>("-0.0"), uint8_t(0)));
+    IN_RANGE_EXT_ASSERT(parses_to(parse_to_integer<int8_t>("000.00e99999999999"), int8_t(0)));
+    IN_RANGE_EXT_ASSERT(parse_to_integer<int64_t>("9223372036854775808").status == parse_status::above);
+    IN_RANGE_EXT_ASSERT(parse_to_integer<int64_t>("9.2233720368547758075e18").status == parse_status::above);
+    IN_RANGE_EXT_ASSERT(parse_to_integer<int64_t>("9.2233720368547758065e18").status == parse_status::not_integer);
+    IN_RANGE_EXT_ASSERT(parse_to_integer<int8_t>("-128.5").status == parse_status::below);
+    IN_RANGE_EXT_ASSERT(parse_to_integer<int8_t>("1e99999999999").status == parse_status::above);
+    IN_RANGE_EXT_ASSERT(parse_to_integer<uint8_t>("-1e-3").status == parse_status::below);
+    IN_RANGE_EXT_ASSERT(parse_to_integer<int32_t>("-INFINITY").status == parse_status::below);
+    IN_RANGE_EXT_ASSERT(parse_to_integer<int32_t>("NaN").status == parse_status::not_integer);
+    IN_RANGE_EXT_ASSERT(parse_to_integer<int32_t>("0.5").status == parse_status::not_integer);
+    for (const char *text : {"", "-", ".", "1e", "1e+", "1.2.3", " 1", "1 ", "0x10", "e5", "infinit"})
+        IN_RANGE_EXT_ASSERT(parse_to_integer<int32_t>(text).status == parse_status::invalid);
+
+    // Text columns: the short fields are converted digit by digit, the rest eight digits at a time.
+    {
+        const std::string_view column = "12\r\n-7\n\n3000000000.0\n1.5e3\n2147483647\n-2147483649\nabc\n-0\n-123456789012\n0000000000012345\n";
+        int64_t column_values[11] = {};
+        std::uint8_t column_validity[2] = {};
+        const auto parsed = in_range_ext::parse_column(column, '\n', std::span<int64_t>(column_values), column_validity);
+        IN_RANGE_EXT_ASSERT(parsed.fields == 11 && parsed.valid == 9 && column_validity[0] == 0x7b && column_validity[1] == 0x07);
+        IN_RANGE_EXT_ASSERT(column_values[0] == 12 && column_values[1] == -7 && column_values[2] == 0 && column_values[3] == 3000000000);
+        IN_RANGE_EXT_ASSERT(column_values[4] == 1500 && column_values[6] == -2147483649 && column_values[9] == -123456789012);
+        IN_RANGE_EXT_ASSERT(column_values[10] == 12345);
+
+        int32_t narrow[11] = {};
+        IN_RANGE_EXT_ASSERT(in_range_ext::parse_column(column, '\n', std::span<int32_t>(narrow), column_validity).valid == 6);
+        IN_RANGE_EXT_ASSERT(column_validity[0] == 0x33 && column_validity[1] == 0x05 && narrow[5] == INT32_MAX && narrow[6] == 0);
+
+        double reals[3] = {};
+        IN_RANGE_EXT_ASSERT(in_range_ext::parse_column("1.5,1e999,-inf", ',', std::span<double>(reals), column_validity).valid == 2);
+        IN_RANGE_EXT_ASSERT(column_validity[0] == 0x05 && reals[0] == 1.5 && reals[1] == 0 && reals[2] == -HUGE_VAL);
+
+        long double wide[2] = {};
+        IN_RANGE_EXT_ASSERT(in_range_ext::parse_column("0.25,inf", ',', std::span<long double>(wide), column_validity).valid == 2);
+        IN_RANGE_EXT_ASSERT(wide[0] == 0.25L && wide[1] == HUGE_VALL);
+    }
+
+#if defined __cpp_lib_expected && __cpp_lib_expected >= 202202L
+    static_assert(numeric_cast<int, in_range_ext::expected_on_failure>(2.5) == 2);
+    static_assert(numeric_cast<int, in_range_ext::expected_on_failure>(-inf).error() == range_outcome::below);
+#endif
 }
@@ -20,6 +20,156 @@
 //
 //   returns true iff value f (of floating-point type FSrc) is in range for floating-point type FDst
 //   currently limited to pairs of floating-point types with the same radix
+//
+// template<integer Dst, integer Src> constexpr bool in_range(Src i)
+//
+//   same as std::in_range<Dst>(i)
+//
+// concept range_checkable<Dst, Src>
+//
+//   matches pairs of types for which in_range<Dst>(Src) is defined
+//
+// template<class Dst, class Src> constexpr size_t in_range(span<const Src> src, span<bool> mask)
+// template<class Dst, class Src> constexpr size_t in_range_strided(const Src *src, ptrdiff_t src_stride, size_t n,
+//                                                                  bool *mask, ptrdiff_t mask_stride = 1)
+// template<class Dst, class Src, ...> size_t in_range(mdspan<Src, ...> src, mdspan<bool, ...> mask)
+//
+//   batch forms: set each mask element to in_range<Dst>(the corresponding src element), and return
+//   the number of elements in range; the mdspan form accepts any strided layout and requires <mdspan>
+//
+// template<class Dst, class Src> constexpr size_t in_range(span<const Src> src, const uint8_t *validity,
+//                                                         size_t validity_offset, uint8_t *bitmap)
+// template<class Dst, class Src> constexpr size_t in_range(span<const Src> src, const uint8_t *validity,
+//                                                         size_t validity_offset, span<bool> mask)
+//
+//   nullable batch forms: as above, but values whose bit in the Arrow-style validity bitmap is clear
+//   are reported as not in range, whatever their payload; the first writes an Arrow-style bitmap
+//
+// template<floating_point F> struct compiled_bounds { F min_in_range, max_in_range; compiled_bounds(I lo, I hi); }
+// template<floating_point F, integer I> constexpr bool in_range_bounds(F f, I lo, I hi)
+// template<floating_point F> constexpr bool in_range_bounds(F f, const compiled_bounds<F> &bounds)
+//
+//   return true iff f is in the integer interval [lo, hi] given at runtime, exactly; compiled_bounds
+//   converts the interval to F once, and the batch forms above have in_range_bounds counterparts
+//   taking it in place of Dst
+//
+// template<auto Lo, auto Hi, floating_point F> constexpr bool in_range(F f)
+//
+//   returns true iff f is in the integer interval [Lo, Hi] fixed at compile time, exactly
+//
+// template<class Dst, class Src, integer Index> size_t in_range_dict(span<const Src> dictionary, span<const Index> indices,
+//                                                                   span<bool> mask)
+// template<class Dst, class Src, integer Index> size_t in_range_dict(span<const Src> dictionary, span<const Index> indices,
+//                                                                   const uint8_t *validity, size_t validity_offset,
+//                                                                   uint8_t *bitmap)
+// template<class Dst, class Src, integer Length> constexpr size_t in_range_rle(span<const Src> run_values,
+//                                                                             span<const Length> run_lengths, span<bool> mask)
+//
+//   batch forms for dictionary- and run-length-encoded columns, checking each dictionary entry or
+//   run once
+//
+// enum class range_outcome { in_range, nan, above, below }
+// template<class Dst, class Src> constexpr range_outcome range_outcome_of(Src s)
+//
+//   classifies s against the range of Dst
+//
+// template<class Src> struct range_stats
+// template<class Dst, class Src> class range_validator
+//
+//   streaming validation: feed(span<const Src>) accepts successive chunks of any size, and stats()
+//   returns counts of each outcome, the extremes seen and the position of the first failure
+//
+// template<class Src> constexpr void merge(range_stats<Src> &stats, const range_stats<Src> &later)
+//
+//   combines statistics for consecutive parts of a sequence
+//
+// template<class Dst, class Policy = throw_on_failure, class Src> constexpr auto numeric_cast(Src s)
+//
+//   converts s to Dst if it is in range; otherwise Policy decides what happens, one of
+//   throw_on_failure (throws bad_numeric_cast), terminate_on_failure, saturate_on_failure (nearest
+//   value of Dst, 0 or NaN for NaN), errno_on_failure (saturates and sets errno), call_on_failure<fn>
+//   (returns fn(s, outcome)) and expected_on_failure (returns std::expected<Dst, range_outcome>,
+//   requires <expected>)
+//
+// template<class Dst, floating_point Src> constexpr size_t convert_saturating(span<const Src> src, span<Dst> dst)
+//
+//   converts floating-point values to an integer or fixed-point type as saturate_on_failure does,
+//   returning the number of values saturated
+//
+// template<integer Dst, floating_point Src> constexpr size_t convert_checked(span<const Src> src, span<Dst> dst, span<bool> mask)
+// template<integer Dst, floating_point Src> constexpr size_t convert_optimistic(span<const Src> src, span<Dst> dst, span<bool> mask)
+// template<integer Dst, floating_point Src> size_t convert_fe_checked(span<const Src> src, span<Dst> dst, span<bool> mask)
+//
+//   convert values in range for Dst, writing 0 for the others and setting mask as in_range does;
+//   convert_optimistic converts first and rechecks only the lanes the hardware marked, where it can
+//   (x86, to int32_t, or int64_t with AVX-512DQ); convert_fe_checked converts blocks without checks
+//   and tests FE_INVALID once per block, where the flag is exact
+//
+// enum class conversion_strategy { checked, optimistic, fe_flags }
+// struct conversion_stats
+// template<integer Dst, floating_point Src> class adaptive_converter
+//
+//   converts a sequence fed in chunks block by block as convert_checked does, choosing for each block
+//   the conversion that suits the failure density of the one before; stats() counts the blocks each
+//   conversion handled and gives the one chosen next
+//
+// template<int Bits = 0, floating_point F, signed_integral Sample>
+// constexpr size_t convert_pcm(span<const F> src, size_t channels, span<Sample> dst, span<size_t> clips)
+//
+//   converts interleaved audio samples, full scale at [-1, 1), to Bits-bit PCM (16, 24 in int32_t or
+//   32, say), rounding and saturating, and counts the samples that clipped in each channel
+//
+// struct export_u8_policy { uint8_t nan_value; }
+// struct export_u8_result { size_t clamped; size_t nan; }
+// template<floating_point F> constexpr export_u8_result export_u8(span<const F> src, span<uint8_t> dst,
+//                                                                export_u8_policy policy = {})
+//
+//   writes pixel components in [0, 1] as 8-bit values, scaled by 255, rounded and clamped to exactly
+//   [0, 255], with NaN written as policy.nan_value, and counts the values clamped and the NaNs
+//
+// template<integer IntRep, int FracBits> struct fixed_point
+//
+//   binary fixed-point number (Q format) raw / 2^FracBits; usable as the destination of in_range and
+//   its batch forms, numeric_cast and convert_saturating from floating-point types with radix 2
+//
+// enum class parse_status { ok, invalid, not_integer, above, below }
+// template<integer I> struct parse_result { I value; parse_status status; }
+// template<integer I> parse_result<I> parse_to_integer(string_view text)
+//
+//   parses decimal text, in integer or floating-point notation (e.g. "3000000000.0", "1.5e9"), and
+//   decides exactly, without rounding, whether its value is an integer in range for I
+//
+// struct column_parse_result { size_t fields; size_t valid; }
+// template<class T> column_parse_result parse_column(string_view text, char delimiter, span<T> values,
+//                                                    uint8_t *validity)
+//
+//   parses a column of delimiter-separated numeric fields into values (integer or floating-point),
+//   writing an Arrow-style validity bitmap in which fields that are empty, malformed or out of range
+//   for T are clear
+//
+// struct site_counts
+// vector<site_counts> instrumentation_snapshot()
+//
+//   opt-in instrumentation, compiled only if IN_RANGE_EXT_INSTRUMENTATION is defined: the scalar
+//   in_range forms and numeric_cast count their outcomes per call site, and
+//   instrumentation_snapshot() returns the counts summed over all threads
+//
+// struct failure_record
+// using failure_hook = void (*)(const failure_record &)
+// failure_hook set_failure_hook(failure_hook hook)
+//
+//   opt-in failure tracing, compiled only if IN_RANGE_EXT_TRACE is defined: the scalar in_range
+//   forms and numeric_cast pass each value found out of range, with its types, outcome and call site, to the
+//   installed hook (see in_range_ext_trace.h for a sampling one)
+//
+// enum class block_range { all_in, all_out, mixed }
+// template<integer I> struct for_block { I base; unsigned bit_width; size_t count; const uint8_t *packed; }
+// template<class Dst, integer I> constexpr block_range classify_for_block(I base, unsigned bit_width)
+// template<class Dst, integer I> constexpr size_t in_range_for(const for_block<I> &block, span<bool> mask)
+// template<class Dst, integer I> constexpr bool all_in_range_for(span<const for_block<I>> blocks)
+//
+//   forms for frame-of-reference bit-packed integer blocks, which decide whole blocks from the block
+//   header where possible and unpack only blocks straddling a boundary of the range
 // 
 // -------------------------------------------------------------------------------------------------
 //
@@ -73,13 +223,55 @@
 #include <algorithm>
 #include <array>
 #include <bit>
+#include <cerrno>
+#include <cfenv>
 #include <cfloat>
+#include <charconv>
+#include <climits>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#if defined __has_include
+#if __has_include(<expected>)
+#include <expected>
+#endif
+#endif
 #include <limits>
+#include <memory>
+#if defined __has_include
+#if __has_include(<mdspan>)
+#include <mdspan>
+#endif
+#endif
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <version>
+#if defined IN_RANGE_EXT_INSTRUMENTATION || defined IN_RANGE_EXT_TRACE
+#include <atomic>
+#include <source_location>
+#endif
+#ifdef IN_RANGE_EXT_INSTRUMENTATION
+#include <mutex>
+#include <vector>
+#endif
+#ifdef IN_RANGE_EXT_TRACE
+#include <variant>
+#endif
+
+// x86 with SSE2: convert_optimistic uses the truncating conversion instructions directly.
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define IN_RANGE_EXT_X86_CONVERSIONS 1
+#include <immintrin.h>
+#else
+#define IN_RANGE_EXT_X86_CONVERSIONS 0
+#endif
 
 namespace in_range_ext
 {
@@ -91,6 +283,29 @@ concept integer = std::is_integral_v<T> && !std::is_same_v<std::remove_cv_t<T>,
 
 #define IN_RANGE_EXT_ASSERT(expr) (void)(!!(expr) ? 0 : (fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #expr), std::abort(), 0))
 
+// With IN_RANGE_EXT_INSTRUMENTATION or IN_RANGE_EXT_TRACE defined (each must be, or not be, in every
+// translation unit), the scalar in_range forms and numeric_cast take a trailing defaulted
+// std::source_location. The first makes them record every outcome at run time, the second report
+// failures to a hook; see "Instrumentation" and "Failure tracing" below. Otherwise they are
+// unchanged.
+#if defined IN_RANGE_EXT_INSTRUMENTATION || defined IN_RANGE_EXT_TRACE
+#define IN_RANGE_EXT_SITE , std::source_location site = std::source_location::current()
+#else
+#define IN_RANGE_EXT_SITE
+#endif
+#ifdef IN_RANGE_EXT_INSTRUMENTATION
+#define IN_RANGE_EXT_RECORD(Dst, value) (std::is_constant_evaluated() ? void() : detail::record_outcome<Dst>(site, value))
+#else
+#define IN_RANGE_EXT_RECORD(Dst, value) ((void)0)
+#endif
+#ifdef IN_RANGE_EXT_TRACE
+#define IN_RANGE_EXT_ON_FAILURE(Dst, value, in)                                                                                            \
+    if (!(in) && !std::is_constant_evaluated()) [[unlikely]]                                                                               \
+    detail::trace_failure<Dst>(site, value)
+#else
+#define IN_RANGE_EXT_ON_FAILURE(Dst, value, in) ((void)0)
+#endif
+
 namespace detail
 {
 namespace constexpr_cmath
@@ -397,9 +612,9 @@ public:
     }
 
     // Conversion from integer.
-    // Result is truncated, not rounded, to num_digits of precision.
+    // Result is truncated, not rounded, to precision (at most num_digits) digits.
     template <integer I>
-    constexpr explicit decomp(I i)
+    constexpr explicit decomp(I i, int precision = num_digits)
         : rep{
               .category = i != 0 ? FP_NORMAL : FP_ZERO,
               .signbit = i < 0,
@@ -417,7 +632,7 @@ public:
         // Extract digits, least significant first.
         for (int d = idigits - 1; d >= 0; --d)
         {
-            if (d < num_digits) // Drop digits beyond specified precision.
+            if (d < std::min(precision, num_digits)) // Drop digits beyond specified precision.
                 rep.digits[unsigned(d)] = u % radix;
             u /= radix;
         }
@@ -430,9 +645,20 @@ public:
     }
 };
 
+// Number of digits of the decomp shared by all range_bounds of a radix: enough for 128-bit
+// integers (twice the digits of uintmax_t) and so for every common floating-point type. Sharing
+// one class instantiates decomp, decomp_rep and their comparisons once per radix rather than once
+// per precision occurring among the pairs of types checked; precisions beyond it get their own.
+template <int radix> constexpr int decomp_capacity()
+{
+    return 2 * count_digits<radix>(std::numeric_limits<std::uintmax_t>::max());
+}
+
+template <int radix, int num_digits> using shared_decomp = decomp<radix, std::max(num_digits, decomp_capacity<radix>())>;
+
 // Verify round-trip on some basic values.
 using float_limits = std::numeric_limits<float>;
-using dfloat = decomp<float_limits::radix, float_limits::digits>;
+using dfloat = shared_decomp<float_limits::radix, float_limits::digits>;
 constexpr int dfloat_radix = std::numeric_limits<float>::radix;
 
 static_assert(float(dfloat(-0.0f)) == -0.0f && constexpr_cmath::signbit(float(dfloat(-0.0f))));
@@ -451,78 +677,2121 @@ static_assert(float(dfloat(-1)) == -1);
 static_assert(float(dfloat(+1)) == +1);
 static_assert(float(dfloat(-(dfloat_radix - 1))) == -(dfloat_radix - 1));
 static_assert(float(dfloat(+(dfloat_radix - 1))) == +(dfloat_radix - 1));
-} // namespace detail
+// Highest and lowest values of type Src in the range of type Dst, as compile-time constants
+// min_in_range and max_in_range of type Src. Specialized below for each supported pair of types;
+// the primary template is empty so that unsupported pairs can be detected (see range_checkable).
+template <class Dst, class Src> struct range_bounds
+{
+};
 
-// in_range<integer>(floating_point)
-template <integer I, std::floating_point F> constexpr bool in_range(F f)
+// range_bounds<integer, floating_point>
+template <integer I, std::floating_point F> struct range_bounds<I, F>
 {
     using flimits = std::numeric_limits<F>;
     using ilimits = std::numeric_limits<I>;
 
-    using fdecomp = detail::decomp<flimits::radix, flimits::digits>;
-
-    constexpr fdecomp dimin(ilimits::lowest()), dimax(ilimits::max()); // Truncated (if needed) to F's precision.
-    constexpr fdecomp dfmin(flimits::lowest()), dfmax(flimits::max());
+    using fdecomp = shared_decomp<flimits::radix, flimits::digits>;
 
-    constexpr F min_in_range(std::max(dfmin, dimin));
-    constexpr F max_in_range(std::min(dfmax, dimax));
+    // Truncated (if needed) to F's precision.
+    static constexpr fdecomp dimin{ilimits::lowest(), flimits::digits}, dimax{ilimits::max(), flimits::digits};
+    static constexpr fdecomp dfmin{flimits::lowest()}, dfmax{flimits::max()};
 
-    return min_in_range <= f && f <= max_in_range;
-}
+    static constexpr F min_in_range{std::max(dfmin, dimin)};
+    static constexpr F max_in_range{std::min(dfmax, dimax)};
+};
 
-// in_range<floating_point>(integer)
-template <std::floating_point F, integer I> constexpr bool in_range(I i)
+// range_bounds<floating_point, integer>
+template <std::floating_point F, integer I> struct range_bounds<F, I>
 {
     using flimits = std::numeric_limits<F>;
     using ilimits = std::numeric_limits<I>;
-    constexpr F fmin = flimits::lowest(), fmax = flimits::max();
-    constexpr I imin = ilimits::lowest(), imax = ilimits::max();
-    constexpr int fradix = flimits::radix;
+    static constexpr F fmin = flimits::lowest(), fmax = flimits::max();
+    static constexpr I imin = ilimits::lowest(), imax = ilimits::max();
+    static constexpr int fradix = flimits::radix;
 
     // Precision accommodates all finite values of either type.
-    constexpr int fdecomp_digits = std::max({
-        flimits::digits,                    //
-        detail::count_digits<fradix>(imin), //
-        detail::count_digits<fradix>(imax)  //
+    static constexpr int fdecomp_digits = std::max({
+        flimits::digits,            //
+        count_digits<fradix>(imin), //
+        count_digits<fradix>(imax)  //
     });
-    using fdecomp = detail::decomp<fradix, fdecomp_digits>;
+    using fdecomp = shared_decomp<fradix, fdecomp_digits>;
 
-    constexpr fdecomp dimin(imin), dimax(imax);
-    constexpr fdecomp dfmin(fmin), dfmax(fmax);
+    static constexpr fdecomp dimin{imin}, dimax{imax};
+    static constexpr fdecomp dfmin{fmin}, dfmax{fmax};
 
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4056) // warning C4056: overflow in floating-point constant arithmetic
                                 // we're specifically checking for overflow first!
 #endif
-    constexpr I min_in_range = dimin < dfmin ? I(fmin) : imin;
-    constexpr I max_in_range = dfmax < dimax ? I(fmax) : imax;
+    static constexpr I min_in_range = dimin < dfmin ? I(fmin) : imin;
+    static constexpr I max_in_range = dfmax < dimax ? I(fmax) : imax;
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
+};
 
-    return min_in_range <= i && i <= max_in_range;
-}
+// range_bounds<integer_dst, integer_src>
+template <integer Dst, integer Src> struct range_bounds<Dst, Src>
+{
+    using dlimits = std::numeric_limits<Dst>;
+    using slimits = std::numeric_limits<Src>;
 
-// in_range<floating_point_dst>(floating_point_src)
+    static constexpr Src min_in_range = std::cmp_less(slimits::lowest(), dlimits::lowest()) ? Src(dlimits::lowest()) : slimits::lowest();
+    static constexpr Src max_in_range = std::cmp_greater(slimits::max(), dlimits::max()) ? Src(dlimits::max()) : slimits::max();
+};
+
+// range_bounds<floating_point_dst, floating_point_src>
 // radix must match for now
-template <std::floating_point Dst, std::floating_point Src> constexpr bool in_range(Src f)
+template <std::floating_point Dst, std::floating_point Src> struct range_bounds<Dst, Src>
 {
     using dlimits = std::numeric_limits<Dst>;
     using slimits = std::numeric_limits<Src>;
     static_assert(dlimits::radix == slimits::radix, "radices must match in current implementation");
 
     // Precision accommodates all finite values of either type.
-    constexpr int fdecomp_digits = std::max(dlimits::digits, slimits::digits);
-    using fdecomp = detail::decomp<dlimits::radix, fdecomp_digits>;
+    static constexpr int fdecomp_digits = std::max(dlimits::digits, slimits::digits);
+    using fdecomp = shared_decomp<dlimits::radix, fdecomp_digits>;
 
-    constexpr fdecomp dmin(dlimits::lowest()), dmax(dlimits::max());
-    constexpr fdecomp smin(slimits::lowest()), smax(slimits::max());
+    static constexpr fdecomp dmin{dlimits::lowest()}, dmax{dlimits::max()};
+    static constexpr fdecomp smin{slimits::lowest()}, smax{slimits::max()};
 
-    constexpr Src min_in_range(std::max(dmin, smin));
-    constexpr Src max_in_range(std::min(dmax, smax));
+    static constexpr Src min_in_range{std::max(dmin, smin)};
+    static constexpr Src max_in_range{std::min(dmax, smax)};
+};
 
-    return min_in_range <= f && f <= max_in_range;
+#ifdef IN_RANGE_EXT_INSTRUMENTATION
+template <class Dst, class Src> void record_outcome(const std::source_location &site, Src value);
+#endif
+#ifdef IN_RANGE_EXT_TRACE
+template <class Dst, class Src> void trace_failure(const std::source_location &site, Src value);
+#endif
+} // namespace detail
+
+// -------------------------------------------------------------------------------------------------
+// Fixed point.
+//
+// fixed_point<IntRep, FracBits> is the binary fixed-point (Q format) number raw / 2^FracBits, for
+// example fixed_point<int16_t, 15> for Q15. Its range is [lowest() / 2^FracBits, max() / 2^FracBits]
+// of IntRep, and since scaling by a power of 2 is exact, the floating-point bounds are those of
+// IntRep, found by decomp, scaled. Conversion from floating point truncates toward zero, as for
+// integers.
+
+template <integer IntRep, int FracBits>
+    requires(FracBits >= 0 && FracBits <= std::numeric_limits<IntRep>::digits)
+struct fixed_point
+{
+    using rep = IntRep;
+    static constexpr int frac_bits = FracBits;
+
+    IntRep raw{};
+
+    // 2^FracBits in F.
+    template <std::floating_point F> static constexpr F scale = detail::constexpr_cmath::scalbn(F(1), FracBits);
+
+    constexpr fixed_point() = default;
+
+    // Truncates; f * 2^FracBits must be in range for IntRep (see in_range).
+    template <std::floating_point F> constexpr explicit fixed_point(F f) : raw(static_cast<IntRep>(f * scale<F>))
+    {
+    }
+
+    static constexpr fixed_point from_raw(IntRep raw)
+    {
+        fixed_point q;
+        q.raw = raw;
+        return q;
+    }
+
+    template <std::floating_point F> constexpr explicit operator F() const
+    {
+        return static_cast<F>(raw) / scale<F>;
+    }
+
+    friend constexpr bool operator==(const fixed_point &, const fixed_point &) = default;
+};
+} // namespace in_range_ext
+
+// Only the members with an unambiguous fixed-point meaning: digits counts the bits of the value, as
+// for IntRep, and epsilon is one unit in the last place. The others (digits10, is_exact,
+// round_error, infinity and the like) are left undeclared rather than inherited from IntRep.
+template <class IntRep, int FracBits> class std::numeric_limits<in_range_ext::fixed_point<IntRep, FracBits>>
+{
+    using q = in_range_ext::fixed_point<IntRep, FracBits>;
+
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = std::numeric_limits<IntRep>::is_signed;
+    static constexpr bool is_integer = false;
+    static constexpr int radix = 2;
+    static constexpr int digits = std::numeric_limits<IntRep>::digits;
+    static constexpr q min() noexcept
+    {
+        return q::from_raw(std::numeric_limits<IntRep>::min());
+    }
+    static constexpr q max() noexcept
+    {
+        return q::from_raw(std::numeric_limits<IntRep>::max());
+    }
+    static constexpr q lowest() noexcept
+    {
+        return q::from_raw(std::numeric_limits<IntRep>::lowest());
+    }
+    static constexpr q epsilon() noexcept
+    {
+        return q::from_raw(1);
+    }
+};
+
+namespace in_range_ext
+{
+namespace detail
+{
+template <class T> constexpr bool is_fixed_point = false;
+template <class IntRep, int FracBits> constexpr bool is_fixed_point<fixed_point<IntRep, FracBits>> = true;
+
+// The integer type holding T's value: T itself, or a fixed-point type's representation.
+template <class T> struct representation
+{
+    using type = T;
+};
+template <class IntRep, int FracBits> struct representation<fixed_point<IntRep, FracBits>>
+{
+    using type = IntRep;
+};
+
+// range_bounds<fixed_point, floating_point>
+template <class IntRep, int FracBits, std::floating_point F>
+    requires(std::numeric_limits<F>::radix == 2)
+struct range_bounds<fixed_point<IntRep, FracBits>, F>
+{
+    using ibounds = range_bounds<IntRep, F>;
+
+    static constexpr F min_in_range = ibounds::min_in_range / fixed_point<IntRep, FracBits>::template scale<F>;
+    static constexpr F max_in_range = ibounds::max_in_range / fixed_point<IntRep, FracBits>::template scale<F>;
+};
+} // namespace detail
+
+// concept range_checkable: in_range<Dst>(Src) is defined.
+template <class Dst, class Src>
+concept range_checkable = requires {
+    { detail::range_bounds<Dst, Src>::min_in_range } -> std::convertible_to<Src>;
+    { detail::range_bounds<Dst, Src>::max_in_range } -> std::convertible_to<Src>;
+};
+
+// in_range<integer>(floating_point)
+template <integer I, std::floating_point F> constexpr bool in_range(F f IN_RANGE_EXT_SITE)
+{
+    using bounds = detail::range_bounds<I, F>;
+    IN_RANGE_EXT_RECORD(I, f);
+    const bool in = bounds::min_in_range <= f && f <= bounds::max_in_range;
+    IN_RANGE_EXT_ON_FAILURE(I, f, in);
+    return in;
+}
+
+// in_range<floating_point>(integer)
+template <std::floating_point F, integer I> constexpr bool in_range(I i IN_RANGE_EXT_SITE)
+{
+    using bounds = detail::range_bounds<F, I>;
+    IN_RANGE_EXT_RECORD(F, i);
+    const bool in = bounds::min_in_range <= i && i <= bounds::max_in_range;
+    IN_RANGE_EXT_ON_FAILURE(F, i, in);
+    return in;
+}
+
+// in_range<floating_point_dst>(floating_point_src)
+// radix must match for now
+template <std::floating_point Dst, std::floating_point Src> constexpr bool in_range(Src f IN_RANGE_EXT_SITE)
+{
+    using bounds = detail::range_bounds<Dst, Src>;
+    IN_RANGE_EXT_RECORD(Dst, f);
+    const bool in = bounds::min_in_range <= f && f <= bounds::max_in_range;
+    IN_RANGE_EXT_ON_FAILURE(Dst, f, in);
+    return in;
+}
+
+// in_range<fixed_point>(floating_point)
+template <class Q, std::floating_point F>
+    requires detail::is_fixed_point<Q> && range_checkable<Q, F>
+constexpr bool in_range(F f IN_RANGE_EXT_SITE)
+{
+    using bounds = detail::range_bounds<Q, F>;
+    IN_RANGE_EXT_RECORD(Q, f);
+    const bool in = bounds::min_in_range <= f && f <= bounds::max_in_range;
+    IN_RANGE_EXT_ON_FAILURE(Q, f, in);
+    return in;
+}
+
+// in_range<integer_dst>(integer_src)
+// Same as std::in_range; provided so that every range_checkable pair has a scalar form.
+template <integer Dst, integer Src> constexpr bool in_range(Src i IN_RANGE_EXT_SITE)
+{
+    IN_RANGE_EXT_RECORD(Dst, i);
+    const bool in = std::in_range<Dst>(i);
+    IN_RANGE_EXT_ON_FAILURE(Dst, i, in);
+    return in;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Batch forms.
+//
+// These apply the same test to many values. The kernels are written without branches on the data
+// (both comparisons are always evaluated and combined with &), so that compilers can vectorize the
+// contiguous loop.
+
+#if defined __GNUC__ || defined __clang__
+#define IN_RANGE_EXT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define IN_RANGE_EXT_PREFETCH(addr) ((void)(addr))
+#endif
+
+namespace detail
+{
+// Contiguous kernel: mask[k] = lo <= src[k] <= hi. Returns number of values in range.
+template <class Src> constexpr std::size_t check_interval(const Src *src, std::size_t n, Src lo, Src hi, bool *mask)
+{
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        const bool in = (lo <= src[k]) & (src[k] <= hi);
+        mask[k] = in;
+        count += in;
+    }
+    return count;
+}
+
+// Strided kernel, strides in elements (may be zero or negative). Falls back to the contiguous
+// kernel when both strides are 1. For strides of a cache line or more, every element touches a new
+// line, so prefetch a fixed distance ahead.
+template <class Src>
+constexpr std::size_t check_interval_strided(const Src *src, std::ptrdiff_t src_stride, std::size_t n, Src lo, Src hi, bool *mask,
+                                             std::ptrdiff_t mask_stride)
+{
+    if (src_stride == 1 && mask_stride == 1)
+        return check_interval(src, n, lo, hi, mask);
+
+    constexpr std::size_t prefetch_distance = 8;
+    const bool prefetch = !std::is_constant_evaluated() && std::size_t(src_stride < 0 ? -src_stride : src_stride) * sizeof(Src) >= 64;
+
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        if (prefetch && k + prefetch_distance < n)
+            IN_RANGE_EXT_PREFETCH(src + std::ptrdiff_t(k + prefetch_distance) * src_stride);
+
+        const Src s = src[std::ptrdiff_t(k) * src_stride];
+        const bool in = (lo <= s) & (s <= hi);
+        mask[std::ptrdiff_t(k) * mask_stride] = in;
+        count += in;
+    }
+    return count;
+}
+// Validity bitmaps use the Arrow layout: bit k is bit (k % 8) of byte k / 8, set for non-null.
+// Reads count <= 8 bits starting at bit offset `bit`, without touching bytes beyond the last bit
+// read. A null bitmap means all values are valid.
+constexpr unsigned load_bits(const std::uint8_t *bitmap, std::size_t bit, unsigned count)
+{
+    if (bitmap == nullptr)
+        return (1u << count) - 1;
+    const std::uint8_t *p = bitmap + bit / 8;
+    const unsigned shift = unsigned(bit % 8);
+    unsigned bits = unsigned(p[0]) >> shift;
+    if (shift + count > 8)
+        bits |= unsigned(p[1]) << (8 - shift);
+    return bits & ((1u << count) - 1);
+}
+
+// Number of bits set in an 8-bit value. Without a popcount instruction (baseline x86-64),
+// std::popcount is a call to a libgcc routine, once per 8 values in the bitmap kernels.
+constexpr unsigned popcount8(unsigned bits)
+{
+#if (defined __GNUC__ || defined __clang__) && (defined __x86_64__ || defined __i386__) && !defined __POPCNT__
+    bits -= (bits >> 1) & 0x55;
+    bits = (bits & 0x33) + ((bits >> 2) & 0x33);
+    return (bits + (bits >> 4)) & 0x0f;
+#else
+    return unsigned(std::popcount(bits));
+#endif
+}
+
+// Packs in-range results for up to 8 values into the low bits of a byte.
+template <class Src> constexpr unsigned check_interval_bits(const Src *src, unsigned count, Src lo, Src hi)
+{
+    unsigned bits = 0;
+    for (unsigned j = 0; j < count; ++j)
+        bits |= unsigned((lo <= src[j]) & (src[j] <= hi)) << j;
+    return bits;
+}
+
+// Nullable kernel with bitmap output: bit k of out = valid(k) && lo <= src[k] <= hi. Works a byte
+// at a time so the validity AND costs one operation per 8 values. Trailing bits are cleared.
+template <class Src>
+constexpr std::size_t check_interval_nullable(const Src *src, std::size_t n, Src lo, Src hi, const std::uint8_t *validity, std::size_t validity_offset,
+                                              std::uint8_t *out)
+{
+    std::size_t count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) // Whole bytes, with a constant trip count for the inner loop.
+    {
+        const unsigned bits = check_interval_bits(src + i, 8, lo, hi) & load_bits(validity, validity_offset + i, 8);
+        out[i / 8] = std::uint8_t(bits);
+        count += popcount8(bits);
+    }
+    if (i != n)
+    {
+        const unsigned block = unsigned(n - i);
+        const unsigned bits = check_interval_bits(src + i, block, lo, hi) & load_bits(validity, validity_offset + i, block);
+        out[i / 8] = std::uint8_t(bits);
+        count += popcount8(bits);
+    }
+    return count;
+}
+
+// Nullable kernel with bool output: mask[k] = valid(k) && lo <= src[k] <= hi.
+template <class Src>
+constexpr std::size_t check_interval_nullable(const Src *src, std::size_t n, Src lo, Src hi, const std::uint8_t *validity, std::size_t validity_offset,
+                                              bool *mask)
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; i += 8)
+    {
+        const unsigned block = unsigned(std::min<std::size_t>(8, n - i));
+        const unsigned valid = load_bits(validity, validity_offset + i, block);
+        for (unsigned j = 0; j < block; ++j)
+        {
+            const bool in = (lo <= src[i + j]) & (src[i + j] <= hi) & bool((valid >> j) & 1);
+            mask[i + j] = in;
+            count += in;
+        }
+    }
+    return count;
+}
+} // namespace detail
+
+// in_range<dst>(span<const src>, span<bool>)
+// Sets mask[k] = in_range<Dst>(src[k]) for each k; returns number of values in range.
+template <class Dst, class Src>
+    requires range_checkable<Dst, Src>
+constexpr std::size_t in_range(std::span<const Src> src, std::span<bool> mask)
+{
+    using bounds = detail::range_bounds<Dst, Src>;
+    IN_RANGE_EXT_ASSERT(mask.size() >= src.size());
+    return detail::check_interval(src.data(), src.size(), bounds::min_in_range, bounds::max_in_range, mask.data());
+}
+
+// in_range_strided<dst>(src, src_stride, n, mask, mask_stride)
+// Strided form for columns embedded in arrays of structs etc. Strides are in elements.
+template <class Dst, class Src>
+    requires range_checkable<Dst, Src>
+constexpr std::size_t in_range_strided(const Src *src, std::ptrdiff_t src_stride, std::size_t n, bool *mask, std::ptrdiff_t mask_stride = 1)
+{
+    using bounds = detail::range_bounds<Dst, Src>;
+    return detail::check_interval_strided(src, src_stride, n, bounds::min_in_range, bounds::max_in_range, mask, mask_stride);
+}
+
+// in_range<dst>(span<const src>, validity, validity_offset, bitmap)
+// in_range<dst>(span<const src>, validity, validity_offset, span<bool>)
+// Nullable forms: element k counts as in range only if bit (validity_offset + k) of the Arrow-style
+// validity bitmap is set; the payload of null elements is ignored. validity may be null (no nulls).
+// The bitmap output must hold (src.size() + 7) / 8 bytes. Returns number of valid values in range.
+template <class Dst, class Src>
+    requires range_checkable<Dst, Src>
+constexpr std::size_t in_range(std::span<const Src> src, const std::uint8_t *validity, std::size_t validity_offset, std::uint8_t *bitmap)
+{
+    using bounds = detail::range_bounds<Dst, Src>;
+    return detail::check_interval_nullable(src.data(), src.size(), bounds::min_in_range, bounds::max_in_range, validity, validity_offset, bitmap);
+}
+
+template <class Dst, class Src>
+    requires range_checkable<Dst, Src>
+constexpr std::size_t in_range(std::span<const Src> src, const std::uint8_t *validity, std::size_t validity_offset, std::span<bool> mask)
+{
+    using bounds = detail::range_bounds<Dst, Src>;
+    IN_RANGE_EXT_ASSERT(mask.size() >= src.size());
+    return detail::check_interval_nullable(src.data(), src.size(), bounds::min_in_range, bounds::max_in_range, validity, validity_offset, mask.data());
+}
+
+#if defined __cpp_lib_mdspan && __cpp_lib_mdspan >= 202207L
+// in_range<dst>(mdspan<src>, mdspan<bool>)
+// Any strided layout (layout_right, layout_left, layout_stride). If both views cover their
+// elements contiguously in the same order the whole view goes to the contiguous kernel; otherwise
+// the view is walked one line at a time along a unit-stride dimension of src where there is one.
+template <class Dst, class Src, class Extents, class SrcLayout, class MaskLayout>
+    requires range_checkable<Dst, std::remove_const_t<Src>> && (SrcLayout::template mapping<Extents>::is_always_strided()) &&
+             (MaskLayout::template mapping<Extents>::is_always_strided())
+std::size_t in_range(std::mdspan<Src, Extents, SrcLayout> src, std::mdspan<bool, Extents, MaskLayout> mask)
+{
+    using S = std::remove_const_t<Src>;
+    using bounds = detail::range_bounds<Dst, S>;
+    using index_type = typename Extents::index_type;
+    constexpr std::size_t rank = Extents::rank();
+
+    IN_RANGE_EXT_ASSERT(src.extents() == mask.extents());
+
+    if constexpr (rank == 0)
+    {
+        const S s = src.data_handle()[0];
+        return (mask.data_handle()[0] = (bounds::min_in_range <= s) & (s <= bounds::max_in_range));
+    }
+    else
+    {
+        if (src.empty())
+            return 0;
+
+        bool same_strides = true;
+        for (std::size_t r = 0; r < rank; ++r)
+            same_strides = same_strides && src.stride(r) == mask.stride(r);
+        if (same_strides && src.is_exhaustive() && mask.is_exhaustive())
+            return detail::check_interval<S>(src.data_handle(), src.size(), bounds::min_in_range, bounds::max_in_range, mask.data_handle());
+
+        // Inner dimension: the last with unit stride in src, otherwise the last.
+        std::size_t inner = rank - 1;
+        for (std::size_t r = rank; r-- > 0;)
+            if (src.stride(r) == 1)
+            {
+                inner = r;
+                break;
+            }
+
+        std::size_t count = 0;
+        std::array<index_type, rank> idx{};
+        for (;;)
+        {
+            std::ptrdiff_t src_offset = 0, mask_offset = 0;
+            for (std::size_t r = 0; r < rank; ++r)
+            {
+                src_offset += std::ptrdiff_t(idx[r]) * std::ptrdiff_t(src.stride(r));
+                mask_offset += std::ptrdiff_t(idx[r]) * std::ptrdiff_t(mask.stride(r));
+            }
+            count += detail::check_interval_strided<S>(src.data_handle() + src_offset, std::ptrdiff_t(src.stride(inner)), std::size_t(src.extent(inner)),
+                                                       bounds::min_in_range, bounds::max_in_range, mask.data_handle() + mask_offset,
+                                                       std::ptrdiff_t(mask.stride(inner)));
+
+            // Advance over the remaining dimensions, last fastest.
+            std::size_t r = rank;
+            while (r-- > 0)
+            {
+                if (r == inner)
+                    continue;
+                if (++idx[r] < src.extent(r))
+                    break;
+                idx[r] = 0;
+            }
+            if (r == std::size_t(-1))
+                return count;
+        }
+    }
+}
+#endif // defined __cpp_lib_mdspan && __cpp_lib_mdspan >= 202207L
+
+// -------------------------------------------------------------------------------------------------
+// Runtime bounds.
+//
+// Checks against an integer interval [lo, hi] known only at runtime (from a schema, say). As for
+// the type limits, the interval is converted once, exactly, to the lowest and highest values of F
+// inside it, after which each check is two comparisons. Truncating an integer to F's precision with
+// decomp gives the nearest value of F toward zero. That is the bound when the integer is
+// representable or when toward zero is inward (a negative lo, a positive hi); otherwise the bound is
+// the next value of F away from zero.
+
+// f is in range iff lo <= f <= hi, exactly; a default-constructed object admits no value.
+template <std::floating_point F> struct compiled_bounds
+{
+    F min_in_range = std::numeric_limits<F>::max(); // Empty unless constructed from an interval.
+    F max_in_range = std::numeric_limits<F>::lowest();
+
+    constexpr compiled_bounds() = default;
+
+    template <integer I> constexpr compiled_bounds(I lo, I hi)
+    {
+        using flimits = std::numeric_limits<F>;
+        using bounds = detail::range_bounds<F, I>;
+        using fdecomp = typename bounds::fdecomp;
+
+        const fdecomp dlo{lo}, dhi{hi};
+        if (hi < lo || bounds::dfmax < dlo || dhi < bounds::dfmin)
+            return; // No value of F is in range.
+
+        // Step of F away from zero from a nonzero integer value t of F (whose ilogb is >= 0).
+        const auto away_from_zero = [](F t) {
+            const F step = detail::constexpr_cmath::scalbn(F(1), detail::constexpr_cmath::ilogb(t) - (flimits::digits - 1));
+            return t < 0 ? t - step : t + step;
+        };
+
+        if (dlo < bounds::dfmin)
+            min_in_range = flimits::lowest();
+        else
+        {
+            const fdecomp truncated{lo, flimits::digits};
+            min_in_range = F(truncated);
+            if (truncated < dlo) // Positive and not representable: round up.
+                min_in_range = away_from_zero(min_in_range);
+        }
+
+        if (bounds::dfmax < dhi)
+            max_in_range = flimits::max();
+        else
+        {
+            const fdecomp truncated{hi, flimits::digits};
+            max_in_range = F(truncated);
+            if (dhi < truncated) // Negative and not representable: round down.
+                max_in_range = away_from_zero(max_in_range);
+        }
+    }
+};
+
+// in_range_bounds(f, bounds)
+template <std::floating_point F> constexpr bool in_range_bounds(F f, const compiled_bounds<F> &bounds)
+{
+    return bounds.min_in_range <= f && f <= bounds.max_in_range;
+}
+
+// in_range_bounds(f, lo, hi)
+// Converts the bounds on each call; for repeated checks against the same interval, construct a
+// compiled_bounds once.
+template <std::floating_point F, integer I> constexpr bool in_range_bounds(F f, I lo, I hi)
+{
+    return in_range_bounds(f, compiled_bounds<F>(lo, hi));
+}
+
+namespace detail
+{
+// Integer type holding both Lo and Hi.
+template <auto Lo, auto Hi> using constant_bounds_int = std::conditional_t<std::cmp_less(Lo, 0) || std::cmp_less(Hi, 0), std::intmax_t, std::uintmax_t>;
+
+template <std::floating_point F, auto Lo, auto Hi>
+constexpr compiled_bounds<F> constant_bounds{constant_bounds_int<Lo, Hi>(Lo), constant_bounds_int<Lo, Hi>(Hi)};
+} // namespace detail
+
+// in_range<lo, hi>(f)
+// As in_range_bounds(f, lo, hi) for bounds fixed at compile time, where it compiles to two
+// comparisons with constants, as in_range<integer> does.
+template <auto Lo, auto Hi, std::floating_point F>
+    requires integer<decltype(Lo)> && integer<decltype(Hi)> &&
+             (std::in_range<detail::constant_bounds_int<Lo, Hi>>(Lo) && std::in_range<detail::constant_bounds_int<Lo, Hi>>(Hi))
+constexpr bool in_range(F f)
+{
+    constexpr F min_in_range = detail::constant_bounds<F, Lo, Hi>.min_in_range;
+    constexpr F max_in_range = detail::constant_bounds<F, Lo, Hi>.max_in_range;
+    return min_in_range <= f && f <= max_in_range;
+}
+
+// in_range_bounds(span<const f>, bounds, span<bool>)
+// in_range_bounds(src, src_stride, n, bounds, mask, mask_stride)
+// in_range_bounds(span<const f>, bounds, validity, validity_offset, bitmap)
+// Batch forms, as in_range<Dst> but against bounds.
+template <std::floating_point F> constexpr std::size_t in_range_bounds(std::span<const F> src, const compiled_bounds<F> &bounds, std::span<bool> mask)
+{
+    IN_RANGE_EXT_ASSERT(mask.size() >= src.size());
+    return detail::check_interval(src.data(), src.size(), bounds.min_in_range, bounds.max_in_range, mask.data());
+}
+
+template <std::floating_point F>
+constexpr std::size_t in_range_bounds(const F *src, std::ptrdiff_t src_stride, std::size_t n, const compiled_bounds<F> &bounds, bool *mask,
+                                      std::ptrdiff_t mask_stride = 1)
+{
+    return detail::check_interval_strided(src, src_stride, n, bounds.min_in_range, bounds.max_in_range, mask, mask_stride);
+}
+
+template <std::floating_point F>
+constexpr std::size_t in_range_bounds(std::span<const F> src, const compiled_bounds<F> &bounds, const std::uint8_t *validity, std::size_t validity_offset,
+                                      std::uint8_t *bitmap)
+{
+    return detail::check_interval_nullable(src.data(), src.size(), bounds.min_in_range, bounds.max_in_range, validity, validity_offset, bitmap);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Encoded columns.
+//
+// With dictionary encoding each distinct value is checked once, and the per-row result is a gather
+// from the dictionary's mask; with run-length encoding each run is checked once.
+
+namespace detail
+{
+// Asserts index is a valid position in a dictionary of the given size. Negative indices convert to
+// large unsigned values, so one comparison suffices.
+template <integer Index> constexpr std::size_t dictionary_position(Index index, std::size_t dictionary_size)
+{
+    const auto position = static_cast<std::make_unsigned_t<Index>>(index);
+    IN_RANGE_EXT_ASSERT(std::cmp_less(position, dictionary_size));
+    return std::size_t(position);
+}
+
+// Gathers per-row results from a dictionary mask. Null rows are not looked up, so their index
+// payload may be garbage. Bitmap output as for check_interval_nullable.
+template <integer Index>
+constexpr std::size_t gather_nullable(const bool *dictionary_mask, std::size_t dictionary_size, const Index *indices, std::size_t n,
+                                      const std::uint8_t *validity, std::size_t validity_offset, std::uint8_t *out)
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; i += 8)
+    {
+        const unsigned block = unsigned(std::min<std::size_t>(8, n - i));
+        const unsigned valid = load_bits(validity, validity_offset + i, block);
+        unsigned bits = 0;
+        for (unsigned j = 0; j < block; ++j)
+            if ((valid >> j) & 1)
+                bits |= unsigned(dictionary_mask[dictionary_position(indices[i + j], dictionary_size)]) << j;
+        out[i / 8] = std::uint8_t(bits);
+        count += popcount8(bits);
+    }
+    return count;
+}
+} // namespace detail
+
+// in_range_dict<dst>(span<const src> dictionary, span<const index> indices, span<bool> mask)
+// Dictionary-encoded form: mask[k] = in_range<Dst>(dictionary[indices[k]]). Every index must be a
+// valid position in dictionary. Returns number of rows in range.
+template <class Dst, class Src, integer Index>
+    requires range_checkable<Dst, Src>
+std::size_t in_range_dict(std::span<const Src> dictionary, std::span<const Index> indices, std::span<bool> mask)
+{
+    IN_RANGE_EXT_ASSERT(mask.size() >= indices.size());
+
+    const std::unique_ptr<bool[]> dictionary_mask(new bool[dictionary.size()]);
+    in_range<Dst>(dictionary, std::span<bool>(dictionary_mask.get(), dictionary.size()));
+
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < indices.size(); ++k)
+    {
+        const bool in = dictionary_mask[detail::dictionary_position(indices[k], dictionary.size())];
+        mask[k] = in;
+        count += in;
+    }
+    return count;
+}
+
+// in_range_dict<dst>(span<const src> dictionary, span<const index> indices, validity, validity_offset, bitmap)
+// Nullable dictionary-encoded form, with validity and bitmap as for the nullable batch forms. Only
+// the indices of non-null rows need be valid.
+template <class Dst, class Src, integer Index>
+    requires range_checkable<Dst, Src>
+std::size_t in_range_dict(std::span<const Src> dictionary, std::span<const Index> indices, const std::uint8_t *validity, std::size_t validity_offset,
+                          std::uint8_t *bitmap)
+{
+    const std::unique_ptr<bool[]> dictionary_mask(new bool[dictionary.size()]);
+    in_range<Dst>(dictionary, std::span<bool>(dictionary_mask.get(), dictionary.size()));
+
+    return detail::gather_nullable(dictionary_mask.get(), dictionary.size(), indices.data(), indices.size(), validity, validity_offset, bitmap);
+}
+
+// in_range_rle<dst>(span<const src> run_values, span<const length> run_lengths, span<bool> mask)
+// Run-length-encoded form: run r covers run_lengths[r] consecutive rows with value run_values[r].
+// mask must hold the total length of all runs. Returns number of rows in range.
+template <class Dst, class Src, integer Length>
+    requires range_checkable<Dst, Src>
+constexpr std::size_t in_range_rle(std::span<const Src> run_values, std::span<const Length> run_lengths, std::span<bool> mask)
+{
+    IN_RANGE_EXT_ASSERT(run_lengths.size() == run_values.size());
+
+    // Compared directly rather than through the scalar form, which would record each run under a
+    // call site in this header.
+    using bounds = detail::range_bounds<Dst, Src>;
+    std::size_t row = 0, count = 0;
+    for (std::size_t r = 0; r < run_values.size(); ++r)
+    {
+        IN_RANGE_EXT_ASSERT(std::cmp_greater_equal(run_lengths[r], 0) && std::cmp_less_equal(run_lengths[r], mask.size() - row));
+        const auto length = std::size_t(run_lengths[r]);
+        const bool in = bounds::min_in_range <= run_values[r] && run_values[r] <= bounds::max_in_range;
+        std::fill_n(mask.data() + row, length, in);
+        row += length;
+        count += in ? length : 0;
+    }
+    return count;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Outcomes and statistics.
+
+// Why a value is or is not in range: not a number, or above or below the range.
+enum class range_outcome
+{
+    in_range,
+    nan,
+    above,
+    below
+};
+
+// range_outcome_of<dst>(src)
+template <class Dst, class Src>
+    requires range_checkable<Dst, Src>
+constexpr range_outcome range_outcome_of(Src s)
+{
+    using bounds = detail::range_bounds<Dst, Src>;
+    if (bounds::min_in_range <= s && s <= bounds::max_in_range)
+        return range_outcome::in_range;
+    else if (s < bounds::min_in_range)
+        return range_outcome::below;
+    else if (s > bounds::max_in_range)
+        return range_outcome::above;
+    else
+        return range_outcome::nan;
+}
+
+// Running statistics over a sequence of values checked against the range of some type.
+template <class Src> struct range_stats
+{
+    static constexpr std::size_t npos = std::size_t(-1);
+
+    std::size_t count = 0; // Values seen.
+    std::size_t num_in_range = 0;
+    std::size_t num_nan = 0;
+    std::size_t num_above = 0;
+    std::size_t num_below = 0;
+
+    // Extremes of the values seen, excluding NaNs; min > max if there were none.
+    Src min = std::numeric_limits<Src>::has_infinity ? std::numeric_limits<Src>::infinity() : std::numeric_limits<Src>::max();
+    Src max = std::numeric_limits<Src>::has_infinity ? -std::numeric_limits<Src>::infinity() : std::numeric_limits<Src>::lowest();
+
+    std::size_t first_failure = npos; // Position of the first value not in range.
+};
+
+// merge(stats, later)
+// Combines statistics for consecutive parts of a sequence: afterwards stats covers its part
+// followed by later's.
+template <class Src> constexpr void merge(range_stats<Src> &stats, const range_stats<Src> &later)
+{
+    if (stats.first_failure == stats.npos && later.first_failure != later.npos)
+        stats.first_failure = stats.count + later.first_failure;
+    stats.count += later.count;
+    stats.num_in_range += later.num_in_range;
+    stats.num_nan += later.num_nan;
+    stats.num_above += later.num_above;
+    stats.num_below += later.num_below;
+    stats.min = later.min < stats.min ? later.min : stats.min;
+    stats.max = later.max > stats.max ? later.max : stats.max;
+}
+
+namespace detail
+{
+// Adds n values to stats; offset is the position of src[0] in the whole sequence. One pass of
+// branch-free reductions, plus a search for the first failure only in the chunk containing it.
+template <class Src>
+constexpr void accumulate(range_stats<Src> &stats, const Src *src, std::size_t n, std::size_t offset, Src lo, Src hi)
+{
+    std::size_t below = 0, above = 0, nan = 0;
+    Src min = stats.min, max = stats.max;
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        const Src s = src[k];
+        below += s < lo;
+        above += s > hi;
+        if constexpr (std::floating_point<Src>)
+            nan += !(s == s);
+        min = s < min ? s : min;
+        max = s > max ? s : max;
+    }
+
+    const std::size_t failures = below + above + nan;
+    if (failures != 0 && stats.first_failure == stats.npos)
+        for (std::size_t k = 0; k < n; ++k)
+            if (!(lo <= src[k] && src[k] <= hi))
+            {
+                stats.first_failure = offset + k;
+                break;
+            }
+
+    stats.count += n;
+    stats.num_in_range += n - failures;
+    stats.num_nan += nan;
+    stats.num_above += above;
+    stats.num_below += below;
+    stats.min = min;
+    stats.max = max;
+}
+} // namespace detail
+
+// range_validator<dst, src>
+// Validates an unbounded sequence of Src values against the range of Dst, fed in chunks of any
+// size, keeping range_stats for the whole sequence. Does not allocate.
+template <class Dst, class Src>
+    requires range_checkable<Dst, Src>
+class range_validator
+{
+    range_stats<Src> totals;
+
+public:
+    constexpr range_validator() = default;
+
+    // Checks the next chunk of the sequence.
+    constexpr void feed(std::span<const Src> chunk)
+    {
+        using bounds = detail::range_bounds<Dst, Src>;
+        detail::accumulate(totals, chunk.data(), chunk.size(), totals.count, bounds::min_in_range, bounds::max_in_range);
+    }
+
+    constexpr const range_stats<Src> &stats() const
+    {
+        return totals;
+    }
+
+    // Starts a new sequence.
+    constexpr void reset()
+    {
+        totals = {};
+    }
+};
+
+// -------------------------------------------------------------------------------------------------
+// Checked conversion.
+//
+// numeric_cast<Dst, Policy>(s) tests s as in_range does and converts it with static_cast; the policy
+// is a type, so its handling of failure is fixed at compile time and costs nothing on success. A
+// policy P provides
+//
+//   template <class Dst> using result = ...; // returned by numeric_cast<Dst, P>, constructible from Dst
+//   template <class Dst, class Src> static result<Dst> failure(Src s, range_outcome outcome);
+
+class bad_numeric_cast : public std::range_error
+{
+    range_outcome why;
+
+public:
+    explicit bad_numeric_cast(range_outcome outcome)
+        : std::range_error(outcome == range_outcome::nan     ? "numeric_cast: NaN"
+                           : outcome == range_outcome::above ? "numeric_cast: value above range"
+                                                             : "numeric_cast: value below range"),
+          why(outcome)
+    {
+    }
+
+    range_outcome outcome() const noexcept
+    {
+        return why;
+    }
+};
+
+namespace detail
+{
+// Value of Dst nearest to a value s outside its range: the limit on the side of s, preserving
+// infinity for floating-point Dst; NaN converts to 0, or to NaN for floating-point Dst.
+template <class Dst, class Src> constexpr Dst saturated(Src s, range_outcome outcome)
+{
+    using dlimits = std::numeric_limits<Dst>;
+    if constexpr (std::floating_point<Dst>)
+    {
+        if (outcome == range_outcome::nan)
+            return dlimits::quiet_NaN();
+        if constexpr (std::floating_point<Src>)
+            if (s == std::numeric_limits<Src>::infinity() || s == -std::numeric_limits<Src>::infinity())
+                return outcome == range_outcome::above ? dlimits::infinity() : -dlimits::infinity();
+        return outcome == range_outcome::above ? dlimits::max() : dlimits::lowest();
+    }
+    else
+    {
+        (void)s;
+        return outcome == range_outcome::above ? dlimits::max() : outcome == range_outcome::below ? dlimits::lowest() : Dst{};
+    }
+}
+} // namespace detail
+
+struct throw_on_failure
+{
+    template <class Dst> using result = Dst;
+    template <class Dst, class Src> static Dst failure(Src, range_outcome outcome)
+    {
+        throw bad_numeric_cast(outcome);
+    }
+};
+
+struct terminate_on_failure
+{
+    template <class Dst> using result = Dst;
+    template <class Dst, class Src> [[noreturn]] static Dst failure(Src, range_outcome) noexcept
+    {
+        std::terminate();
+    }
+};
+
+struct saturate_on_failure
+{
+    template <class Dst> using result = Dst;
+    template <class Dst, class Src> static constexpr Dst failure(Src s, range_outcome outcome)
+    {
+        return detail::saturated<Dst>(s, outcome);
+    }
+};
+
+// Sets errno as strtol and friends do: ERANGE for a value outside the range, EDOM for NaN.
+struct errno_on_failure
+{
+    template <class Dst> using result = Dst;
+    template <class Dst, class Src> static Dst failure(Src s, range_outcome outcome)
+    {
+        errno = outcome == range_outcome::nan ? EDOM : ERANGE;
+        return detail::saturated<Dst>(s, outcome);
+    }
+};
+
+// Handler is a function pointer or captureless lambda called as Handler(s, outcome); its result is
+// converted to Dst.
+template <auto Handler> struct call_on_failure
+{
+    template <class Dst> using result = Dst;
+    template <class Dst, class Src> static constexpr Dst failure(Src s, range_outcome outcome)
+    {
+        return static_cast<Dst>(Handler(s, outcome));
+    }
+};
+
+#if defined __cpp_lib_expected && __cpp_lib_expected >= 202202L
+struct expected_on_failure
+{
+    template <class Dst> using result = std::expected<Dst, range_outcome>;
+    template <class Dst, class Src> static constexpr result<Dst> failure(Src, range_outcome outcome)
+    {
+        return std::unexpected(outcome);
+    }
+};
+#endif
+
+// numeric_cast<dst, policy>(src)
+template <class Dst, class Policy = throw_on_failure, class Src>
+    requires range_checkable<Dst, Src>
+constexpr typename Policy::template result<Dst> numeric_cast(Src s IN_RANGE_EXT_SITE)
+{
+    using bounds = detail::range_bounds<Dst, Src>;
+    IN_RANGE_EXT_RECORD(Dst, s);
+    if (bounds::min_in_range <= s && s <= bounds::max_in_range) [[likely]]
+        return static_cast<Dst>(s);
+    IN_RANGE_EXT_ON_FAILURE(Dst, s, false);
+    return Policy::template failure<Dst>(s, range_outcome_of<Dst>(s));
+}
+
+// convert_saturating<dst>(span<const src>, span<dst>)
+// Batch conversion from floating point to an integer or fixed-point type, saturating as
+// saturate_on_failure does: values outside the range become the limit on their side and NaN
+// becomes 0. Returns the number of values saturated (including NaNs). The value is clamped to the
+// exact bounds before the conversion, without branches, so the loop vectorizes.
+template <class Dst, std::floating_point Src>
+    requires(integer<Dst> || detail::is_fixed_point<Dst>) && range_checkable<Dst, Src>
+constexpr std::size_t convert_saturating(std::span<const Src> src, std::span<Dst> dst)
+{
+    // Scaling by a power of the radix is exact, so a fixed-point value is scaled first and checked
+    // against the bounds of its representation.
+    constexpr bool fixed = detail::is_fixed_point<Dst>;
+    using Rep = typename detail::representation<Dst>::type;
+    using bounds = detail::range_bounds<Rep, Src>;
+    constexpr Src scale = [] {
+        if constexpr (fixed)
+            return Dst::template scale<Src>;
+        else
+            return Src(1);
+    }();
+
+    IN_RANGE_EXT_ASSERT(dst.size() >= src.size());
+    std::size_t saturated = 0;
+    for (std::size_t k = 0; k < src.size(); ++k)
+    {
+        const Src s = src[k] * scale;
+        const bool in = (bounds::min_in_range <= s) & (s <= bounds::max_in_range);
+        Src clamped = s == s ? s : Src(0);
+        clamped = clamped < bounds::min_in_range ? bounds::min_in_range : clamped;
+        clamped = clamped > bounds::max_in_range ? bounds::max_in_range : clamped;
+        // The bounds are the limits of Rep only when Src represents them.
+        Rep converted = static_cast<Rep>(clamped);
+        converted = s < bounds::min_in_range ? std::numeric_limits<Rep>::min() : converted;
+        converted = s > bounds::max_in_range ? std::numeric_limits<Rep>::max() : converted;
+        if constexpr (fixed)
+            dst[k].raw = converted;
+        else
+            dst[k] = converted;
+        saturated += !in;
+    }
+    return saturated;
+}
+
+// convert_checked<dst>(span<const src>, span<dst>, span<bool> mask)
+// Batch conversion from floating point to an integer type: values in range are converted as by
+// numeric_cast and the others written as 0, and mask is set as in_range<Dst> sets it. Returns the
+// number of values in range.
+template <integer Dst, std::floating_point Src>
+    requires range_checkable<Dst, Src>
+constexpr std::size_t convert_checked(std::span<const Src> src, std::span<Dst> dst, std::span<bool> mask)
+{
+    using bounds = detail::range_bounds<Dst, Src>;
+    IN_RANGE_EXT_ASSERT(dst.size() >= src.size() && mask.size() >= src.size());
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < src.size(); ++k)
+    {
+        const Src s = src[k];
+        const bool in = (bounds::min_in_range <= s) & (s <= bounds::max_in_range);
+        dst[k] = static_cast<Dst>(in ? s : Src(0));
+        mask[k] = in;
+        count += in;
+    }
+    return count;
+}
+
+namespace detail
+{
+// The x86 truncating conversions return the "integer indefinite" value, the lowest value of the
+// destination, for NaN and for values out of range. Each specialization converts `lanes` values
+// and returns a bitmask of the lanes that may be out of range: those that came out as that value,
+// and any others that values out of range truncate to.
+template <class Dst, class Src> struct indefinite_conversion;
+
+#if IN_RANGE_EXT_X86_CONVERSIONS
+// Hides the source from the optimizer: GCC treats the conversion intrinsics as its own conversion,
+// out of range undefined, and for constant input folds them to saturated values instead.
+template <class V> V opaque(V v)
+{
+#if defined __GNUC__ || defined __clang__
+    __asm__("" : "+x"(v));
+#endif
+    return v;
+}
+
+template <> struct indefinite_conversion<std::int32_t, float>
+{
+#ifdef __AVX2__
+    static constexpr std::size_t lanes = 8;
+    static unsigned convert(const float *src, std::int32_t *dst)
+    {
+        const __m256i converted = _mm256_cvttps_epi32(opaque(_mm256_loadu_ps(src)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), converted);
+        return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(converted, _mm256_set1_epi32(INT32_MIN)))));
+    }
+#else
+    static constexpr std::size_t lanes = 4;
+    static unsigned convert(const float *src, std::int32_t *dst)
+    {
+        const __m128i converted = _mm_cvttps_epi32(opaque(_mm_loadu_ps(src)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), converted);
+        return unsigned(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(converted, _mm_set1_epi32(INT32_MIN)))));
+    }
+#endif
+};
+
+// Doubles between INT32_MAX and 2^31 truncate to INT32_MAX, so lanes with that value are marked too.
+template <> struct indefinite_conversion<std::int32_t, double>
+{
+    static __m128i limits(__m128i converted)
+    {
+        return _mm_or_si128(_mm_cmpeq_epi32(converted, _mm_set1_epi32(INT32_MIN)), _mm_cmpeq_epi32(converted, _mm_set1_epi32(INT32_MAX)));
+    }
+
+#ifdef __AVX__
+    static constexpr std::size_t lanes = 4;
+    static unsigned convert(const double *src, std::int32_t *dst)
+    {
+        const __m128i converted = _mm256_cvttpd_epi32(opaque(_mm256_loadu_pd(src)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), converted);
+        return unsigned(_mm_movemask_ps(_mm_castsi128_ps(limits(converted))));
+    }
+#else
+    static constexpr std::size_t lanes = 2;
+    static unsigned convert(const double *src, std::int32_t *dst)
+    {
+        const __m128i converted = _mm_cvttpd_epi32(opaque(_mm_loadu_pd(src)));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), converted);
+        return unsigned(_mm_movemask_ps(_mm_castsi128_ps(limits(converted)))) & 3;
+    }
+#endif
+};
+
+#if defined __AVX512DQ__ && defined __AVX512VL__
+template <> struct indefinite_conversion<std::int64_t, float>
+{
+    static constexpr std::size_t lanes = 4;
+    static unsigned convert(const float *src, std::int64_t *dst)
+    {
+        const __m256i converted = _mm256_cvttps_epi64(opaque(_mm_loadu_ps(src)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), converted);
+        return unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(converted, _mm256_set1_epi64x(INT64_MIN)))));
+    }
+};
+
+template <> struct indefinite_conversion<std::int64_t, double>
+{
+    static constexpr std::size_t lanes = 4;
+    static unsigned convert(const double *src, std::int64_t *dst)
+    {
+        const __m256i converted = _mm256_cvttpd_epi64(opaque(_mm256_loadu_pd(src)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), converted);
+        return unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(converted, _mm256_set1_epi64x(INT64_MIN)))));
+    }
+};
+#endif
+#endif // IN_RANGE_EXT_X86_CONVERSIONS
+
+template <class Dst, class Src>
+concept has_indefinite_conversion = requires(const Src *src, Dst *dst) {
+    { indefinite_conversion<Dst, Src>::convert(src, dst) } -> std::same_as<unsigned>;
+};
+} // namespace detail
+
+// convert_optimistic<dst>(span<const src>, span<dst>, span<bool> mask)
+// As convert_checked, for values expected to be almost all in range. Where the hardware conversion
+// marks failures (see indefinite_conversion), it converts first, which costs one integer comparison
+// per vector where the checks cost two floating-point ones, and checks exactly only the lanes that
+// came out as the lowest value of Dst: out of range, NaN, or that value itself (and for double to
+// int32_t, the highest). Elsewhere it is convert_checked.
+template <integer Dst, std::floating_point Src>
+    requires range_checkable<Dst, Src>
+constexpr std::size_t convert_optimistic(std::span<const Src> src, std::span<Dst> dst, std::span<bool> mask)
+{
+    if constexpr (detail::has_indefinite_conversion<Dst, Src>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            using bounds = detail::range_bounds<Dst, Src>;
+            using conversion = detail::indefinite_conversion<Dst, Src>;
+            IN_RANGE_EXT_ASSERT(dst.size() >= src.size() && mask.size() >= src.size());
+            std::size_t failures = 0, k = 0;
+            for (; k + conversion::lanes <= src.size(); k += conversion::lanes)
+            {
+                unsigned marked = conversion::convert(src.data() + k, dst.data() + k);
+                std::fill_n(mask.data() + k, conversion::lanes, true);
+                for (; marked != 0; marked &= marked - 1)
+                {
+                    const std::size_t j = k + unsigned(std::countr_zero(marked));
+                    if (!(bounds::min_in_range <= src[j] && src[j] <= bounds::max_in_range))
+                    {
+                        dst[j] = 0;
+                        mask[j] = false;
+                        ++failures;
+                    }
+                }
+            }
+            return k - failures + convert_checked<Dst>(src.subspan(k), dst.subspan(k), mask.subspan(k));
+        }
+    }
+    return convert_checked<Dst>(src, dst, mask);
+}
+
+namespace detail
+{
+// The hardware conversion also accepts values out of range within 1 of the limits of Dst, which it
+// truncates to the limits, without raising FE_INVALID; Src has no such values when its precision
+// is no more than Dst's.
+template <class Dst, class Src>
+concept exact_invalid_flag = has_indefinite_conversion<Dst, Src> && std::numeric_limits<Src>::digits <= std::numeric_limits<Dst>::digits + 1;
+
+// Values converted between tests of the flag.
+constexpr std::size_t fe_block = 4096;
+} // namespace detail
+
+// convert_fe_checked<dst>(span<const src>, span<dst>, span<bool> mask)
+// As convert_checked, for large arrays expected to be all in range. Where the hardware conversion
+// raises FE_INVALID for exactly the values out of range (see exact_invalid_flag: on x86, float to
+// int32_t, and float or double to int64_t with AVX-512DQ), each block of values is converted without
+// checks and the flag tested once; only a block that raised it is checked value by value.
+// Elsewhere it is convert_optimistic. Either way the caller's floating-point environment, flags and
+// traps, is restored on return, so an enabled FE_INVALID trap does not fire.
+template <integer Dst, std::floating_point Src>
+    requires range_checkable<Dst, Src>
+std::size_t convert_fe_checked(std::span<const Src> src, std::span<Dst> dst, std::span<bool> mask)
+{
+    IN_RANGE_EXT_ASSERT(dst.size() >= src.size() && mask.size() >= src.size());
+    std::fenv_t caller;
+    std::feholdexcept(&caller);
+    std::size_t count = 0;
+    if constexpr (detail::exact_invalid_flag<Dst, Src>)
+    {
+        using conversion = detail::indefinite_conversion<Dst, Src>;
+        for (std::size_t begin = 0; begin < src.size(); begin += detail::fe_block)
+        {
+            const std::size_t end = std::min(begin + detail::fe_block, src.size());
+            const std::size_t vectors_end = begin + (end - begin) / conversion::lanes * conversion::lanes;
+            std::feclearexcept(FE_INVALID);
+            for (std::size_t k = begin; k < vectors_end; k += conversion::lanes)
+                conversion::convert(src.data() + k, dst.data() + k);
+            if (std::fetestexcept(FE_INVALID)) [[unlikely]]
+                count += convert_checked<Dst>(src.subspan(begin, vectors_end - begin), dst.subspan(begin), mask.subspan(begin));
+            else
+            {
+                std::fill_n(mask.data() + begin, vectors_end - begin, true);
+                count += vectors_end - begin;
+            }
+            count += convert_checked<Dst>(src.subspan(vectors_end, end - vectors_end), dst.subspan(vectors_end), mask.subspan(vectors_end));
+        }
+    }
+    else
+        count = convert_optimistic<Dst>(src, dst, mask);
+    std::fesetenv(&caller);
+    return count;
+}
+
+// adaptive_converter<dst, src>
+// The conversion that is fastest depends on how many values fail: convert_fe_checked when none do,
+// convert_optimistic when few do (it rechecks each one in scalar code) and convert_checked, whose
+// cost does not depend on the data where it vectorizes, when many do. adaptive_converter converts a
+// sequence fed in chunks of any size block by block, counting the failures of each block and
+// choosing the conversion for the next one from them, so that it follows data that moves between
+// clean and garbage. The first block, with nothing yet known, is converted by convert_checked.
+enum class conversion_strategy
+{
+    checked,
+    optimistic,
+    fe_flags
+};
+
+struct conversion_stats
+{
+    std::size_t count = 0;
+    std::size_t num_in_range = 0;
+    // Blocks converted with each strategy, indexed by conversion_strategy.
+    std::array<std::size_t, 3> blocks = {};
+    // Changes of strategy between blocks.
+    std::size_t switches = 0;
+    // Strategy for the next block.
+    conversion_strategy strategy = conversion_strategy::checked;
+};
+
+namespace detail
+{
+// Blocks with more than one failure in this many values go to convert_checked. Measured with GCC 12
+// at -O3, convert_optimistic falls behind it at about one failure in 16 from float to int32_t on
+// baseline x86-64, but at about one in 40 from double with AVX2, where convert_checked has wider
+// vectors; 32 lies between, erring toward convert_checked, whose cost does not depend on the data.
+constexpr std::size_t optimistic_values_per_failure = 32;
+} // namespace detail
+
+template <integer Dst, std::floating_point Src>
+    requires range_checkable<Dst, Src>
+class adaptive_converter
+{
+    std::size_t block;
+    conversion_stats totals;
+
+    // Strategy for a block after one of `size` values with `failures` out of range.
+    conversion_strategy next(std::size_t failures, std::size_t size) const
+    {
+        if (failures == 0 && detail::exact_invalid_flag<Dst, Src>)
+            return conversion_strategy::fe_flags;
+        if (failures * detail::optimistic_values_per_failure <= size && detail::has_indefinite_conversion<Dst, Src>)
+            return conversion_strategy::optimistic;
+        return conversion_strategy::checked;
+    }
+
+public:
+    explicit adaptive_converter(std::size_t block_size = detail::fe_block) : block(std::max(block_size, std::size_t(1)))
+    {
+    }
+
+    // Converts the next chunk of the sequence as convert_checked does, returning the number of values
+    // in range.
+    std::size_t convert(std::span<const Src> src, std::span<Dst> dst, std::span<bool> mask)
+    {
+        IN_RANGE_EXT_ASSERT(dst.size() >= src.size() && mask.size() >= src.size());
+        std::size_t count = 0;
+        for (std::size_t begin = 0; begin < src.size(); begin += block)
+        {
+            const std::size_t size = std::min(block, src.size() - begin);
+            const std::span<const Src> in = src.subspan(begin, size);
+            const std::span<Dst> out = dst.subspan(begin, size);
+            const std::span<bool> flags = mask.subspan(begin, size);
+            const conversion_strategy strategy = totals.strategy;
+            const std::size_t converted = strategy == conversion_strategy::fe_flags     ? convert_fe_checked<Dst>(in, out, flags)
+                                          : strategy == conversion_strategy::optimistic ? convert_optimistic<Dst>(in, out, flags)
+                                                                                        : convert_checked<Dst>(in, out, flags);
+            count += converted;
+            ++totals.blocks[std::size_t(strategy)];
+            totals.strategy = next(size - converted, size);
+            totals.switches += totals.strategy != strategy;
+        }
+        totals.count += src.size();
+        totals.num_in_range += count;
+        return count;
+    }
+
+    const conversion_stats &stats() const
+    {
+        return totals;
+    }
+
+    // Starts a new sequence, sampling again from convert_checked.
+    void reset()
+    {
+        totals = {};
+    }
+};
+
+// -------------------------------------------------------------------------------------------------
+// PCM audio.
+//
+// Floating-point samples are full scale at [-1, 1); a Bits-bit sample is the value scaled by
+// 2^(Bits - 1) and rounded, with the exact bounds of a Bits-bit integer deciding what clips. For
+// int32 from float that is 2147483520 (2^31 - 128), the highest float in range, not 2^31.
+
+namespace detail
+{
+// Rounds to an integer as rint does in the default rounding mode (to nearest, ties to even),
+// without the branch or call that rint is on x86-64 without SSE4.1: adding and subtracting
+// 2^(digits - 1), with the sign of f, rounds away the fraction of smaller magnitudes; larger ones
+// are integers already, and are shifted by 0.
+template <std::floating_point F>
+    requires(std::numeric_limits<F>::radix == 2)
+constexpr F round_to_even(F f)
+{
+    constexpr F integral = constexpr_cmath::scalbn(F(1), std::numeric_limits<F>::digits - 1);
+    const F shift = constexpr_cmath::copysign(f, F(1)) < integral ? constexpr_cmath::copysign(integral, f) : F(0);
+    return (f + shift) - shift;
+}
+
+static_assert(round_to_even(2.5f) == 2.0f && round_to_even(3.5f) == 4.0f && round_to_even(-2.5) == -2.0 && round_to_even(-0.75) == -1.0);
+static_assert(round_to_even(8388607.5f) == 8388608.0f && round_to_even(0x1p60) == 0x1p60 && round_to_even(-0x1.8p52) == -0x1.8p52);
+
+// Frames converted between checks for clipping; a block that clipped is scanned again to count
+// its clips per channel.
+constexpr std::size_t pcm_block_frames = 256;
+} // namespace detail
+
+// convert_pcm<bits>(span<const float>, channels, span<sample>, span<size_t> clips)
+// Converts interleaved floating-point samples to Bits-bit PCM in Sample (the width of Sample if
+// Bits is 0; 24-bit samples go in int32_t, sign-extended), saturating samples that clip and NaNs
+// (to 0). Adds the number of samples that clipped, NaNs included, in each channel to clips, and
+// returns the total.
+template <int Bits = 0, std::floating_point F, std::signed_integral Sample>
+    requires(std::numeric_limits<F>::radix == 2)
+constexpr std::size_t convert_pcm(std::span<const F> src, std::size_t channels, std::span<Sample> dst, std::span<std::size_t> clips)
+{
+    constexpr int bits = Bits != 0 ? Bits : std::numeric_limits<Sample>::digits + 1;
+    static_assert(1 < bits && bits <= std::numeric_limits<Sample>::digits + 1, "Sample too narrow");
+    // -2^(bits - 1) and 2^(bits - 1) - 1, without overflow when Sample is intmax_t.
+    constexpr std::intmax_t max_sample = std::intmax_t((std::uintmax_t(1) << (bits - 1)) - 1);
+    constexpr std::intmax_t min_sample = -max_sample - 1;
+    constexpr compiled_bounds<F> bounds = detail::constant_bounds<F, min_sample, max_sample>;
+    constexpr F scale = detail::constexpr_cmath::scalbn(F(1), bits - 1);
+
+    IN_RANGE_EXT_ASSERT(channels != 0 && src.size() % channels == 0);
+    IN_RANGE_EXT_ASSERT(dst.size() >= src.size() && clips.size() >= channels);
+    const std::size_t block = detail::pcm_block_frames * channels;
+    std::size_t clipped = 0;
+    for (std::size_t begin = 0; begin < src.size(); begin += block)
+    {
+        const std::size_t end = std::min(begin + block, src.size());
+        std::size_t block_clipped = 0;
+        for (std::size_t k = begin; k < end; ++k)
+        {
+            // The bounds are integers, so clamping after rounding clamps the rounded value.
+            const F r = detail::round_to_even(src[k] * scale);
+            const bool in = (bounds.min_in_range <= r) & (r <= bounds.max_in_range);
+            F clamped = r == r ? r : F(0);
+            clamped = clamped < bounds.min_in_range ? bounds.min_in_range : clamped;
+            clamped = clamped > bounds.max_in_range ? bounds.max_in_range : clamped;
+            Sample sample = static_cast<Sample>(clamped);
+            sample = r < bounds.min_in_range ? Sample(min_sample) : sample;
+            sample = r > bounds.max_in_range ? Sample(max_sample) : sample;
+            dst[k] = sample;
+            block_clipped += !in;
+        }
+
+        if (block_clipped != 0) [[unlikely]]
+            for (std::size_t k = begin, channel = 0; k < end; ++k, channel = channel + 1 == channels ? 0 : channel + 1)
+                clips[channel] += !in_range_bounds(detail::round_to_even(src[k] * scale), bounds);
+        clipped += block_clipped;
+    }
+    return clipped;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Image export.
+//
+// Floating-point pixel components in [0, 1] are written as 8-bit values by scaling by 255 and
+// rounding; a rounded value is in range as in_range<uint8_t> decides. The layout (interleaved RGBA,
+// planar) does not matter, as each component is converted alone.
+
+// What export_u8 writes for NaN.
+struct export_u8_policy
+{
+    std::uint8_t nan_value = 0;
+};
+
+struct export_u8_result
+{
+    std::size_t clamped = 0; // Rounded below 0 or above 255 (infinities included).
+    std::size_t nan = 0;
+};
+
+// export_u8(span<const float>, span<uint8_t>, policy)
+template <std::floating_point F>
+    requires(std::numeric_limits<F>::radix == 2)
+constexpr export_u8_result export_u8(std::span<const F> src, std::span<std::uint8_t> dst, export_u8_policy policy = {})
+{
+    // The bounds are exactly 0 and 255, so clamping a rounded value to them and converting it is exact.
+    using bounds = detail::range_bounds<std::uint8_t, F>;
+    IN_RANGE_EXT_ASSERT(dst.size() >= src.size());
+    export_u8_result result;
+    for (std::size_t k = 0; k < src.size(); ++k)
+    {
+        const F r = detail::round_to_even(src[k] * F(255));
+        const bool nan = r != r;
+        const bool in = (bounds::min_in_range <= r) & (r <= bounds::max_in_range);
+        F clamped = nan ? F(0) : r;
+        clamped = clamped < bounds::min_in_range ? bounds::min_in_range : clamped;
+        clamped = clamped > bounds::max_in_range ? bounds::max_in_range : clamped;
+        const std::uint8_t value = static_cast<std::uint8_t>(clamped);
+        dst[k] = nan ? policy.nan_value : value;
+        result.clamped += !in & !nan;
+        result.nan += nan;
+    }
+    return result;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Parsing.
+//
+// Text such as "3000000000.0" or "1.5e9" is often used for integers (by JSON writers, for example).
+// Parsing it to double and then checking the result is inexact beyond double's precision; instead
+// the value is kept as its decimal digits and a scale, which decide exactly both whether it is an
+// integer and whether it is in range.
+
+enum class parse_status
+{
+    ok,
+    invalid,     // Not a decimal number.
+    not_integer, // In range, but has a fractional part (or is NaN).
+    above,
+    below
+};
+
+template <integer I> struct parse_result
+{
+    I value{};
+    parse_status status = parse_status::invalid;
+
+    constexpr explicit operator bool() const
+    {
+        return status == parse_status::ok;
+    }
+};
+
+namespace detail
+{
+constexpr bool equal_ignoring_case(std::string_view text, std::string_view lower)
+{
+    return text.size() == lower.size() && std::equal(text.begin(), text.end(), lower.begin(), [](char c, char l) { return (c | 0x20) == l; });
+}
+
+constexpr bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+} // namespace detail
+
+// parse_to_integer<integer>(text)
+// Accepts an optional sign, digits with an optional decimal point (at least one digit in all), and
+// an optional exponent; or "inf", "infinity" or "nan", in any case. The whole of text must match.
+template <integer I>
+    requires(std::numeric_limits<I>::digits <= std::numeric_limits<std::uintmax_t>::digits)
+parse_result<I> parse_to_integer(std::string_view text)
+{
+    using ilimits = std::numeric_limits<I>;
+    const char *const first = text.data(), *const last = first + text.size();
+
+    // Fast path: plain integers.
+    {
+        I value{};
+        const auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ptr == last && ec == std::errc{})
+            return {value, parse_status::ok};
+        if (ptr == last && ec == std::errc::result_out_of_range)
+            return {{}, text.front() == '-' ? parse_status::below : parse_status::above};
+    }
+
+    const char *p = first;
+    const bool negative = p != last && *p == '-';
+    p += p != last && (*p == '-' || *p == '+');
+    const parse_status out_of_range = negative ? parse_status::below : parse_status::above;
+
+    const std::string_view rest(p, std::size_t(last - p));
+    if (detail::equal_ignoring_case(rest, "inf") || detail::equal_ignoring_case(rest, "infinity"))
+        return {{}, out_of_range};
+    if (detail::equal_ignoring_case(rest, "nan"))
+        return {{}, parse_status::not_integer};
+
+    // Mantissa: the digits before and after the decimal point.
+    const char *const int_first = p;
+    while (p != last && detail::is_digit(*p))
+        ++p;
+    const std::string_view int_digits(int_first, std::size_t(p - int_first));
+    std::string_view frac_digits;
+    if (p != last && *p == '.')
+    {
+        const char *const frac_first = ++p;
+        while (p != last && detail::is_digit(*p))
+            ++p;
+        frac_digits = std::string_view(frac_first, std::size_t(p - frac_first));
+    }
+    if (int_digits.empty() && frac_digits.empty())
+        return {};
+
+    // Exponent, saturated well beyond any that could matter.
+    constexpr long exponent_limit = 1L << 24;
+    long exponent = 0;
+    if (p != last && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        const bool negative_exponent = p != last && *p == '-';
+        p += p != last && (*p == '-' || *p == '+');
+        if (p == last || !detail::is_digit(*p))
+            return {};
+        for (; p != last && detail::is_digit(*p); ++p)
+            exponent = std::min(exponent * 10 + (*p - '0'), exponent_limit);
+        exponent = negative_exponent ? -exponent : exponent;
+    }
+    if (p != last)
+        return {};
+
+    // The value is 0.digits * 10^point, where digits is the mantissa's digits without leading or
+    // trailing zeros.
+    const std::size_t num_digits = int_digits.size() + frac_digits.size();
+    const auto digit = [&](std::size_t k) { return k < int_digits.size() ? int_digits[k] : frac_digits[k - int_digits.size()]; };
+    std::size_t begin = 0, end = num_digits;
+    while (begin != end && digit(begin) == '0')
+        ++begin;
+    while (end != begin && digit(end - 1) == '0')
+        --end;
+    if (begin == end)
+        return {I(0), parse_status::ok};
+    if (negative && !ilimits::is_signed)
+        return {{}, parse_status::below};
+    const long point = long(int_digits.size()) - long(begin) + exponent;
+
+    // Integer part, checked against the limit on the value's side of zero.
+    const std::uintmax_t limit = negative ? std::uintmax_t(-(ilimits::lowest() + 1)) + 1 : std::uintmax_t(ilimits::max());
+    std::uintmax_t magnitude = 0;
+    for (long k = 0; k < point; ++k)
+    {
+        const std::size_t position = begin + std::size_t(k);
+        const unsigned d = position < end ? unsigned(digit(position) - '0') : 0;
+        if (magnitude > (limit - d) / 10)
+            return {{}, out_of_range};
+        magnitude = magnitude * 10 + d;
+    }
+
+    const bool fractional = point < long(end - begin);
+    if (fractional)
+        return {{}, magnitude == limit ? out_of_range : parse_status::not_integer};
+    return {negative ? I(-I(magnitude - 1) - 1) : I(magnitude), parse_status::ok};
+}
+
+// Columns of text fields, as in CSV. Fields are found with memchr, which C libraries implement with
+// vector instructions. Integer fields of up to 19 plain digits are converted eight digits at a time
+// in a 64-bit register, and checked against the range of the destination type with range_bounds;
+// anything else (exponents, decimal points, longer digit strings) goes through parse_to_integer.
+// Floating-point fields use std::from_chars.
+
+struct column_parse_result
+{
+    std::size_t fields = 0;
+    std::size_t valid = 0;
+};
+
+namespace detail
+{
+// 8 bytes from p, p[0] in the low byte whatever the byte order (compilers emit a single load).
+constexpr std::uint64_t load_le64(const char *p)
+{
+    std::uint64_t chunk = 0;
+    for (unsigned k = 0; k < 8; ++k)
+        chunk |= std::uint64_t(std::uint8_t(p[k])) << (8 * k);
+    return chunk;
+}
+
+// True iff each byte of chunk is an ASCII digit: the high nibble is 3, and adding 6 does not carry
+// out of the low nibble.
+constexpr bool all_digits(std::uint64_t chunk)
+{
+    return ((chunk & 0xf0f0f0f0f0f0f0f0) | (((chunk + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) == 0x3333333333333333;
+}
+
+// Value of the 8 ASCII digits in chunk, most significant in the low byte, combining pairs of
+// digits, then of pairs, then of quadruples with one multiplication each.
+constexpr std::uint32_t eight_digits(std::uint64_t chunk)
+{
+    chunk = (chunk & 0x0f0f0f0f0f0f0f0f) * 2561 >> 8;
+    chunk = (chunk & 0x00ff00ff00ff00ff) * 6553601 >> 16;
+    return std::uint32_t((chunk & 0x0000ffff0000ffff) * 42949672960001 >> 32);
+}
+
+// Parses the n (1 to 19) characters at p as digits, reading no further than readable_end; returns
+// false if any is not a digit.
+constexpr bool parse_digits(const char *p, std::size_t n, const char *readable_end, std::uint64_t &value)
+{
+    constexpr std::uint32_t powers_of_10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    value = 0;
+    while (n != 0)
+    {
+        const std::size_t k = n % 8 == 0 ? 8 : n % 8; // The short group first.
+        if (readable_end - p >= 8)
+        {
+            // Shift the k digits to the high bytes, and fill the low bytes with leading '0's.
+            std::uint64_t chunk = load_le64(p) << (8 * (8 - k));
+            chunk |= k == 8 ? 0 : 0x3030303030303030 >> (8 * k);
+            if (!all_digits(chunk))
+                return false;
+            value = value * powers_of_10[k] + eight_digits(chunk);
+        }
+        else
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                if (!is_digit(p[j]))
+                    return false;
+                value = value * 10 + unsigned(p[j] - '0');
+            }
+        p += k;
+        n -= k;
+    }
+    return true;
+}
+
+template <integer I> bool parse_field(std::string_view field, const char *readable_end, I &value)
+{
+    const bool negative = !field.empty() && field.front() == '-';
+    const std::size_t num_digits = field.size() - negative;
+    std::uint64_t magnitude = 0;
+    if (num_digits != 0 && num_digits <= 19 && parse_digits(field.data() + negative, num_digits, readable_end, magnitude))
+    {
+        if (!negative)
+        {
+            const bool in = magnitude <= range_bounds<I, std::uint64_t>::max_in_range;
+            value = in ? I(magnitude) : I{};
+            return in;
+        }
+        const std::int64_t negated = std::int64_t(std::uint64_t(0) - magnitude); // Positive if magnitude > 2^63.
+        const bool in = negated <= 0 && range_bounds<I, std::int64_t>::min_in_range <= negated;
+        value = in ? I(negated) : I{};
+        return in;
+    }
+    const parse_result<I> result = parse_to_integer<I>(field);
+    value = result.value;
+    return bool(result);
+}
+
+template <std::floating_point F> bool parse_field(std::string_view field, const char *, F &value)
+{
+    if constexpr (!std::is_same_v<F, float> && !std::is_same_v<F, double>)
+    {
+        // libstdc++ parses long double with strtold, and for "inf" and "nan" runs strlen on the
+        // text, past the end of the field (and of the column), so it is given a terminated copy.
+        const std::string copy(field);
+        const auto [ptr, ec] = std::from_chars(copy.data(), copy.data() + copy.size(), value);
+        const bool ok = ec == std::errc{} && ptr == copy.data() + copy.size() && !copy.empty();
+        value = ok ? value : F{};
+        return ok;
+    }
+    const auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+    const bool ok = ec == std::errc{} && ptr == field.data() + field.size() && !field.empty();
+    value = ok ? value : F{};
+    return ok;
+}
+} // namespace detail
+
+// parse_column<t>(text, delimiter, values, validity)
+// Fields are separated by delimiter; one at the very end of text ends the last field rather than
+// starting an empty one. With '\n' as delimiter a '\r' ending a field is dropped. Field k is parsed
+// into values[k], set to 0 if invalid, and bit k of validity is set iff it is valid (in range for T,
+// and an integer if T is). There must be room for every field.
+template <class T>
+    requires(integer<T> || std::floating_point<T>)
+column_parse_result parse_column(std::string_view text, char delimiter, std::span<T> values, std::uint8_t *validity)
+{
+    const char *p = text.data();
+    const char *const end = p + text.size();
+    column_parse_result result;
+    unsigned bits = 0;
+    while (p != end)
+    {
+        const char *const stop = static_cast<const char *>(std::memchr(p, delimiter, std::size_t(end - p)));
+        std::string_view field(p, std::size_t((stop != nullptr ? stop : end) - p));
+        if (delimiter == '\n' && !field.empty() && field.back() == '\r')
+            field.remove_suffix(1);
+        p = stop != nullptr ? stop + 1 : end;
+
+        IN_RANGE_EXT_ASSERT(result.fields < values.size());
+        const bool valid = detail::parse_field(field, end, values[result.fields]);
+        bits |= unsigned(valid) << (result.fields % 8);
+        result.valid += valid;
+        if (++result.fields % 8 == 0)
+        {
+            validity[result.fields / 8 - 1] = std::uint8_t(bits);
+            bits = 0;
+        }
+    }
+    if (result.fields % 8 != 0)
+        validity[result.fields / 8] = std::uint8_t(bits);
+    return result;
+}
+
+#ifdef IN_RANGE_EXT_INSTRUMENTATION
+// -------------------------------------------------------------------------------------------------
+// Instrumentation.
+//
+// Each thread counts outcomes in its own table of call sites, one cache line per site, so recording
+// is a lookup in a thread-local table and an increment without any read-modify-write atomic or
+// lock. Only the owning thread writes a counter, with a relaxed load and store (plain moves on
+// common hardware), which lets instrumentation_snapshot read it from another thread. Counts of
+// threads that have exited are kept.
+
+// Outcome counts for one call site, indexed by range_outcome.
+struct site_counts
+{
+    std::string_view file, function;
+    std::uint_least32_t line = 0, column = 0;
+    std::array<std::uint64_t, 4> counts{};
+};
+
+namespace detail
+{
+// Call sites per thread; any further sites share one overflow entry, reported with an empty file.
+constexpr std::size_t instrumented_sites_per_thread = 256;
+
+struct alignas(64) site_slot
+{
+    std::atomic<const char *> file{}; // Written last; null while the slot is unused.
+    const char *function = nullptr;
+    std::uint_least32_t line = 0, column = 0;
+    std::array<std::atomic<std::uint64_t>, 4> counts{};
+};
+
+// Adds a slot's counts to the entry for its site in sites, matching sites by name since each
+// translation unit may have its own copy of a file name.
+inline void add_site(std::vector<site_counts> &sites, const site_slot &slot)
+{
+    const char *file = slot.file.load(std::memory_order_acquire);
+    if (file == nullptr)
+        return;
+    auto entry = std::find_if(sites.begin(), sites.end(), [&](const site_counts &s) {
+        return s.line == slot.line && s.column == slot.column && s.file == file && s.function == slot.function;
+    });
+    if (entry == sites.end())
+        entry = sites.insert(sites.end(), {file, slot.function, slot.line, slot.column, {}});
+    for (std::size_t k = 0; k < entry->counts.size(); ++k)
+        entry->counts[k] += slot.counts[k].load(std::memory_order_relaxed);
+}
+
+class site_table;
+
+// All live tables, and the counts of tables whose threads have exited.
+struct site_registry
+{
+    std::mutex mutex;
+    std::vector<const site_table *> tables;
+    std::vector<site_counts> retired;
+};
+
+inline site_registry &registry()
+{
+    static site_registry instance;
+    return instance;
+}
+
+// One thread's sites, in an open-addressed hash table keyed on the source_location contents.
+class site_table
+{
+    std::array<site_slot, instrumented_sites_per_thread> slots;
+    site_slot overflow;
+
+public:
+    site_table()
+    {
+        overflow.function = "";
+        overflow.file.store("", std::memory_order_release);
+        std::lock_guard lock(registry().mutex);
+        registry().tables.push_back(this);
+    }
+
+    site_table(const site_table &) = delete;
+    site_table &operator=(const site_table &) = delete;
+
+    ~site_table()
+    {
+        std::lock_guard lock(registry().mutex);
+        add_to(registry().retired);
+        std::erase(registry().tables, this);
+    }
+
+    site_slot &slot(const std::source_location &site)
+    {
+        const char *file = site.file_name();
+        const std::size_t hash = std::size_t(std::uintptr_t(file) >> 4) ^ (std::size_t(site.line()) * 0x9e3779b1u) ^ site.column();
+        for (std::size_t probe = 0; probe < slots.size(); ++probe)
+        {
+            site_slot &s = slots[(hash + probe) % slots.size()];
+            const char *slot_file = s.file.load(std::memory_order_relaxed);
+            if (slot_file == nullptr)
+            {
+                s.function = site.function_name();
+                s.line = site.line();
+                s.column = site.column();
+                s.file.store(file, std::memory_order_release);
+                return s;
+            }
+            if (slot_file == file && s.line == site.line() && s.column == site.column())
+                return s;
+        }
+        return overflow;
+    }
+
+    // Call with registry().mutex held.
+    void add_to(std::vector<site_counts> &sites) const
+    {
+        for (const site_slot &s : slots)
+            add_site(sites, s);
+        if (std::any_of(overflow.counts.begin(), overflow.counts.end(), [](const auto &c) { return c.load(std::memory_order_relaxed) != 0; }))
+            add_site(sites, overflow);
+    }
+};
+
+inline site_table &thread_sites()
+{
+    thread_local site_table table;
+    return table;
+}
+
+template <class Dst, class Src> void record_outcome(const std::source_location &site, Src value)
+{
+    std::atomic<std::uint64_t> &counter = thread_sites().slot(site).counts[std::size_t(range_outcome_of<Dst>(value))];
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+} // namespace detail
+
+// instrumentation_snapshot()
+// Outcome counts of every call site seen so far, summed over all threads.
+inline std::vector<site_counts> instrumentation_snapshot()
+{
+    std::lock_guard lock(detail::registry().mutex);
+    std::vector<site_counts> sites = detail::registry().retired;
+    for (const detail::site_table *table : detail::registry().tables)
+        table->add_to(sites);
+    return sites;
+}
+#endif // IN_RANGE_EXT_INSTRUMENTATION
+
+#ifdef IN_RANGE_EXT_TRACE
+// -------------------------------------------------------------------------------------------------
+// Failure tracing.
+//
+// Only the failure path is touched: a value in range costs the same comparisons as without tracing,
+// plus a branch on their result. A failure is reported to the installed hook, if any.
+
+// A value found out of range. The value is held exactly, as the widest type of its kind.
+struct failure_record
+{
+    std::source_location site;
+    const char *dst_type = "";
+    const char *src_type = "";
+    range_outcome outcome = range_outcome::nan;
+    std::variant<std::intmax_t, std::uintmax_t, long double> value;
+};
+
+using failure_hook = void (*)(const failure_record &);
+
+namespace detail
+{
+// Names of the types in_range accepts, for failure records.
+template <class T> constexpr const char *type_name()
+{
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_same_v<U, signed char>)
+        return "signed char";
+    else if constexpr (std::is_same_v<U, unsigned char>)
+        return "unsigned char";
+    else if constexpr (std::is_same_v<U, short>)
+        return "short";
+    else if constexpr (std::is_same_v<U, unsigned short>)
+        return "unsigned short";
+    else if constexpr (std::is_same_v<U, int>)
+        return "int";
+    else if constexpr (std::is_same_v<U, unsigned>)
+        return "unsigned";
+    else if constexpr (std::is_same_v<U, long>)
+        return "long";
+    else if constexpr (std::is_same_v<U, unsigned long>)
+        return "unsigned long";
+    else if constexpr (std::is_same_v<U, long long>)
+        return "long long";
+    else if constexpr (std::is_same_v<U, unsigned long long>)
+        return "unsigned long long";
+    else if constexpr (std::is_same_v<U, float>)
+        return "float";
+    else if constexpr (std::is_same_v<U, double>)
+        return "double";
+    else if constexpr (std::is_same_v<U, long double>)
+        return "long double";
+    else if constexpr (is_fixed_point<U>)
+        return "fixed_point";
+    else
+        return "(extended type)";
+}
+
+inline std::atomic<failure_hook> installed_failure_hook{nullptr};
+
+template <class Dst, class Src> void trace_failure(const std::source_location &site, Src value)
+{
+    const failure_hook hook = installed_failure_hook.load(std::memory_order_acquire);
+    if (hook == nullptr)
+        return;
+
+    failure_record record{site, type_name<Dst>(), type_name<Src>(), range_outcome_of<Dst>(value), {}};
+    if constexpr (std::floating_point<Src>)
+        record.value = static_cast<long double>(value);
+    else if constexpr (std::is_signed_v<Src>)
+        record.value = static_cast<std::intmax_t>(value);
+    else
+        record.value = static_cast<std::uintmax_t>(value);
+    hook(record);
+}
+} // namespace detail
+
+// set_failure_hook(hook)
+// Installs hook, or removes the current one if hook is null, and returns the previous hook. The hook
+// may be called concurrently from any thread that checks values.
+inline failure_hook set_failure_hook(failure_hook hook)
+{
+    return detail::installed_failure_hook.exchange(hook, std::memory_order_acq_rel);
+}
+#endif // IN_RANGE_EXT_TRACE
+
+// -------------------------------------------------------------------------------------------------
+// Frame-of-reference (FOR) bit-packed integer blocks.
+//
+// A block stores count values base + delta, each delta packed in bit_width bits, least significant
+// bit first (the usual bit-packing of columnar formats). Its values all lie in the interval
+// [base, base + 2^bit_width - 1], and the values of I in range for Dst also form an interval, so
+// most blocks can be proved wholly in or out of range from base and bit_width alone. Only blocks
+// straddling a boundary are unpacked.
+
+enum class block_range
+{
+    all_in,
+    all_out,
+    mixed
+};
+
+template <integer I> struct for_block
+{
+    I base{};
+    unsigned bit_width{};
+    std::size_t count{};
+    const std::uint8_t *packed{}; // (count * bit_width + 7) / 8 bytes.
+};
+
+namespace detail
+{
+// Reads the width-bit field (width <= 64) starting at bit offset bit.
+constexpr std::uint64_t unpack_bits(const std::uint8_t *packed, std::size_t bit, unsigned width)
+{
+    std::uint64_t value = 0;
+    unsigned got = 0;
+    while (got < width)
+    {
+        const unsigned shift = unsigned((bit + got) % 8);
+        const unsigned take = std::min(8 - shift, width - got);
+        const std::uint64_t byte = (packed[(bit + got) / 8] >> shift) & ((1u << take) - 1);
+        value |= byte << got;
+        got += take;
+    }
+    return value;
+}
+
+// Largest delta a FOR block can hold: 2^bit_width - 1.
+template <integer I> constexpr std::make_unsigned_t<I> for_block_max_delta(unsigned bit_width)
+{
+    using U = std::make_unsigned_t<I>;
+    IN_RANGE_EXT_ASSERT(bit_width <= unsigned(std::numeric_limits<U>::digits));
+    return bit_width == unsigned(std::numeric_limits<U>::digits) ? U(-1) : U((U(1) << bit_width) - 1);
+}
+} // namespace detail
+
+// classify_for_block<dst>(base, bit_width)
+// Whether every value of a FOR block with the given header is in range for Dst, none is, or it
+// depends on the packed deltas.
+template <class Dst, integer I>
+    requires range_checkable<Dst, I>
+constexpr block_range classify_for_block(I base, unsigned bit_width)
+{
+    using bounds = detail::range_bounds<Dst, I>;
+    using U = std::make_unsigned_t<I>;
+    using ilimits = std::numeric_limits<I>;
+    if (bounds::min_in_range <= ilimits::lowest() && ilimits::max() <= bounds::max_in_range)
+        return block_range::all_in;
+
+    // Values are base + delta modulo 2^N, as unpacked, so if a delta can carry base past the
+    // maximum of I the values wrap around to its lowest, and no longer form one interval.
+    const U max_delta = detail::for_block_max_delta<I>(bit_width);
+    if (max_delta > U(U(ilimits::max()) - U(base)))
+        return block_range::mixed;
+
+    const I lo = base, hi = I(U(base) + max_delta);
+    if (bounds::min_in_range <= lo && hi <= bounds::max_in_range)
+        return block_range::all_in;
+    else if (hi < bounds::min_in_range || bounds::max_in_range < lo)
+        return block_range::all_out;
+    else
+        return block_range::mixed;
+}
+
+// in_range_for<dst>(block, mask)
+// Sets mask[k] = in_range<Dst>(value k of block); returns number of values in range. Unpacks the
+// block only if classify_for_block says it is mixed.
+template <class Dst, integer I>
+    requires range_checkable<Dst, I>
+constexpr std::size_t in_range_for(const for_block<I> &block, std::span<bool> mask)
+{
+    using bounds = detail::range_bounds<Dst, I>;
+    using U = std::make_unsigned_t<I>;
+    IN_RANGE_EXT_ASSERT(mask.size() >= block.count);
+
+    switch (classify_for_block<Dst>(block.base, block.bit_width))
+    {
+    case block_range::all_in:
+        std::fill_n(mask.data(), block.count, true);
+        return block.count;
+    case block_range::all_out:
+        std::fill_n(mask.data(), block.count, false);
+        return 0;
+    case block_range::mixed:
+        break;
+    }
+
+    // Unpack a chunk at a time into a local buffer and run the contiguous kernel on it.
+    constexpr std::size_t chunk = 256;
+    std::array<I, chunk> values{};
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < block.count; i += chunk)
+    {
+        const std::size_t n = std::min(chunk, block.count - i);
+        for (std::size_t k = 0; k < n; ++k)
+            values[k] = I(U(block.base) + U(detail::unpack_bits(block.packed, (i + k) * block.bit_width, block.bit_width)));
+        count += detail::check_interval<I>(values.data(), n, bounds::min_in_range, bounds::max_in_range, mask.data() + i);
+    }
+    return count;
+}
+
+// all_in_range_for<dst>(blocks)
+// Whether every value of every block is in range for Dst. Time is proportional to the number of
+// blocks, except for mixed blocks, which are unpacked.
+template <class Dst, integer I>
+    requires range_checkable<Dst, I>
+constexpr bool all_in_range_for(std::span<const for_block<I>> blocks)
+{
+    using bounds = detail::range_bounds<Dst, I>;
+    using U = std::make_unsigned_t<I>;
+
+    for (const for_block<I> &block : blocks)
+    {
+        if (block.count == 0)
+            continue;
+        switch (classify_for_block<Dst>(block.base, block.bit_width))
+        {
+        case block_range::all_in:
+            continue;
+        case block_range::all_out:
+            return false;
+        case block_range::mixed:
+            for (std::size_t k = 0; k < block.count; ++k)
+            {
+                const I value = I(U(block.base) + U(detail::unpack_bits(block.packed, k * block.bit_width, block.bit_width)));
+                if (!(bounds::min_in_range <= value && value <= bounds::max_in_range))
+                    return false;
+            }
+        }
+    }
+    return true;
 }
 
 namespace detail
@@ -0,0 +1,223 @@
+//
+// Arrow C Data Interface entry point for in_range_ext.h.
+//
+// It defines the following in namespace in_range_ext
+//
+// template<class Dst> size_t in_range_arrow(const ArrowSchema &schema, const ArrowArray &array, uint8_t *bitmap)
+//
+//   checks every element of a primitive Arrow array against in_range<Dst>, dispatching on the
+//   schema's format string, and writes the result as an Arrow-style bitmap of (array.length + 7) / 8
+//   bytes; null elements are reported as not in range. Returns the number of bits set.
+//   Throws std::invalid_argument for formats other than the fixed-width integer and floating-point
+//   ones ("c" "C" "s" "S" "i" "I" "l" "L" "f" "g") or for arrays that are not laid out as such.
+//   Dictionary-encoded arrays (integer indices into one of those types) are checked once per
+//   dictionary entry; a non-null index outside the dictionary also throws std::invalid_argument.
+//
+// The ArrowSchema and ArrowArray structs are declared here as specified by the Arrow C Data
+// Interface (a stable ABI), unless ARROW_C_DATA_INTERFACE is already defined, so no Arrow library
+// is needed. Buffers are read in place.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IN_RANGE_EXT_ARROW_H
+#define IN_RANGE_EXT_ARROW_H
+
+#include "in_range_ext.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema
+{
+    // Array type description
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+struct ArrowArray
+{
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace in_range_ext
+{
+namespace detail
+{
+// Calls fn with a value-initialized object of the C++ type for a primitive Arrow format string.
+// Returns false if the format is not one of the supported fixed-width integer/floating-point types.
+template <class Fn> bool visit_arrow_format(std::string_view format, Fn &&fn)
+{
+    if (format.size() != 1)
+        return false;
+
+    switch (format[0])
+    {
+    case 'c': fn(std::int8_t{}); return true;
+    case 'C': fn(std::uint8_t{}); return true;
+    case 's': fn(std::int16_t{}); return true;
+    case 'S': fn(std::uint16_t{}); return true;
+    case 'i': fn(std::int32_t{}); return true;
+    case 'I': fn(std::uint32_t{}); return true;
+    case 'l': fn(std::int64_t{}); return true;
+    case 'L': fn(std::uint64_t{}); return true;
+    case 'f': fn(float{}); return true;
+    case 'g': fn(double{}); return true;
+    default: return false;
+    }
+}
+
+// Buffers of a primitive array of element type T, with the array's offset applied to the values.
+template <class T> struct arrow_primitive
+{
+    const std::uint8_t *validity; // Null if there are no nulls.
+    std::size_t validity_offset;
+    std::span<const T> values;
+
+    explicit arrow_primitive(const ArrowArray &array)
+    {
+        if (array.length < 0 || array.offset < 0 || array.n_buffers != 2 || array.buffers == nullptr)
+            throw std::invalid_argument("in_range_arrow: not a primitive array");
+
+        validity = static_cast<const std::uint8_t *>(array.buffers[0]);
+        if (validity == nullptr && array.null_count != 0)
+            throw std::invalid_argument("in_range_arrow: array has nulls but no validity buffer");
+        validity_offset = std::size_t(array.offset);
+
+        const auto *data = static_cast<const T *>(array.buffers[1]);
+        if (data == nullptr && array.length != 0)
+            throw std::invalid_argument("in_range_arrow: array has no data buffer");
+        if (array.length != 0)
+            values = std::span<const T>(data + array.offset, std::size_t(array.length));
+    }
+};
+
+// Throws unless every non-null index is a position in the dictionary; null rows' indices may be
+// garbage and are not looked at.
+template <integer Index> void check_dictionary_indices(const arrow_primitive<Index> &indices, std::size_t dictionary_size)
+{
+    for (std::size_t k = 0; k < indices.values.size(); ++k)
+        if (load_bits(indices.validity, indices.validity_offset + k, 1) != 0 &&
+            !std::cmp_less(static_cast<std::make_unsigned_t<Index>>(indices.values[k]), dictionary_size))
+            throw std::invalid_argument("in_range_arrow: dictionary index out of range");
+}
+} // namespace detail
+
+template <class Dst> std::size_t in_range_arrow(const ArrowSchema &schema, const ArrowArray &array, std::uint8_t *bitmap)
+{
+    if (schema.format == nullptr)
+        throw std::invalid_argument("in_range_arrow: schema has no format");
+
+    std::size_t count = 0;
+    bool supported = false;
+    if (schema.dictionary == nullptr)
+    {
+        supported = detail::visit_arrow_format(schema.format, [&]<class Src>(Src) {
+            if constexpr (range_checkable<Dst, Src>)
+            {
+                const detail::arrow_primitive<Src> column(array);
+                count = in_range<Dst>(column.values, column.validity, column.validity_offset, bitmap);
+            }
+            else
+                throw std::invalid_argument("in_range_arrow: format not range-checkable for destination type");
+        });
+    }
+    else
+    {
+        // Dictionary-encoded: schema.format describes the indices, schema.dictionary the values.
+        if (schema.dictionary->format == nullptr || array.dictionary == nullptr)
+            throw std::invalid_argument("in_range_arrow: dictionary-encoded array has no dictionary");
+
+        supported = detail::visit_arrow_format(schema.format, [&]<class Index>(Index) {
+            if constexpr (integer<Index>)
+            {
+                const detail::arrow_primitive<Index> indices(array);
+                const bool dictionary_supported = detail::visit_arrow_format(schema.dictionary->format, [&]<class Src>(Src) {
+                    if constexpr (range_checkable<Dst, Src>)
+                    {
+                        // Null dictionary entries are not in range.
+                        const detail::arrow_primitive<Src> dictionary(*array.dictionary);
+                        const std::size_t dictionary_size = dictionary.values.size();
+                        detail::check_dictionary_indices(indices, dictionary_size);
+                        const std::unique_ptr<bool[]> dictionary_mask(new bool[dictionary_size]);
+                        in_range<Dst>(dictionary.values, dictionary.validity, dictionary.validity_offset,
+                                      std::span<bool>(dictionary_mask.get(), dictionary_size));
+                        count = detail::gather_nullable(dictionary_mask.get(), dictionary_size, indices.values.data(), indices.values.size(),
+                                                        indices.validity, indices.validity_offset, bitmap);
+                    }
+                    else
+                        throw std::invalid_argument("in_range_arrow: format not range-checkable for destination type");
+                });
+                if (!dictionary_supported)
+                    throw std::invalid_argument("in_range_arrow: unsupported dictionary format");
+            }
+            else
+                throw std::invalid_argument("in_range_arrow: dictionary indices must be integers");
+        });
+    }
+    if (!supported)
+        throw std::invalid_argument("in_range_arrow: unsupported format");
+
+    return count;
+}
+} // namespace in_range_ext
+
+#endif // IN_RANGE_EXT_ARROW_H
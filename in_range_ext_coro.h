@@ -0,0 +1,396 @@
+//
+// Coroutine interface for in_range_ext.h (C++20 coroutines).
+//
+// It defines the following in namespace in_range_ext
+//
+// template<class T> class task
+//
+//   lazily started coroutine returning T; co_await it to run it and get the result
+//
+// template<class T> T sync_wait(task<T> t)
+//
+//   runs t to completion, blocking the calling thread
+//
+// concept executor<E>
+//
+//   e.post(std::function<void()>) runs the function on the executor's thread(s); post may be called
+//   from any thread. An event loop's scheduler, or a worker_pool.
+//
+// class worker_pool
+//
+//   fixed set of threads running posted work; run(fn, home) is an awaitable that runs fn on a worker
+//   and resumes the awaiting coroutine on the executor home
+//
+// concept async_chunk_source<Source, Src>
+//
+//   source.next() returns an awaiter whose result is std::optional<std::span<const Src>>: the next chunk, valid until
+//   next() is called again, or std::nullopt at the end of the sequence
+//
+// template<class Src> struct validation_result
+//
+//   range_stats for the sequence, plus the number of chunks and of chunks handed to the pool
+//
+// template<class Dst, class Src, async_chunk_source<Src> Source, executor Executor = worker_pool>
+// task<validation_result<Src>> validate_async(Source &source, worker_pool *pool = nullptr, Executor *home = nullptr,
+//                                             size_t offload_threshold = default_offload_threshold)
+//
+//   checks each chunk against the range of Dst as it arrives. Chunks smaller than
+//   offload_threshold are checked inline, on whichever thread resumed the coroutine, since for
+//   them a thread hop costs more than the check; larger ones are checked on the pool, leaving the
+//   thread that produced them free. With a pool, home is required: after an offloaded chunk the
+//   coroutine is resumed through it, normally the executor of the code that awaits the task, so
+//   that the source, the inline checks and the awaiter's continuation stay off the pool's threads.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IN_RANGE_EXT_CORO_H
+#define IN_RANGE_EXT_CORO_H
+
+#include "in_range_ext.h"
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace in_range_ext
+{
+template <class T> class task
+{
+public:
+    struct promise_type
+    {
+        std::optional<T> value;
+        std::exception_ptr exception;
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+
+        task get_return_object()
+        {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        // Resumes whoever awaited the task.
+        auto final_suspend() noexcept
+        {
+            struct final_awaiter
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+                {
+                    return h.promise().continuation;
+                }
+                void await_resume() noexcept
+                {
+                }
+            };
+            return final_awaiter{};
+        }
+
+        template <class U> void return_value(U &&u)
+        {
+            value.emplace(std::forward<U>(u));
+        }
+
+        void unhandled_exception()
+        {
+            exception = std::current_exception();
+        }
+    };
+
+    task(task &&other) noexcept : handle(std::exchange(other.handle, {}))
+    {
+    }
+
+    task &operator=(task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+                handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    ~task()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    // Starts the task, arranging for it to resume the awaiter when done.
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        handle.promise().continuation = awaiter;
+        return handle;
+    }
+
+    T await_resume()
+    {
+        if (handle.promise().exception)
+            std::rethrow_exception(handle.promise().exception);
+        return std::move(*handle.promise().value);
+    }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> h) : handle(h)
+    {
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+namespace detail
+{
+// Eagerly started coroutine that releases a semaphore when it finishes; used by sync_wait.
+struct signalling_coroutine
+{
+    struct promise_type
+    {
+        std::binary_semaphore *done;
+
+        // The semaphore is the coroutine's first parameter.
+        template <class... Args> explicit promise_type(std::binary_semaphore &d, Args &...) : done(&d)
+        {
+        }
+
+        signalling_coroutine get_return_object()
+        {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept
+        {
+            done->release();
+            return {};
+        }
+        void return_void()
+        {
+        }
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+};
+
+template <class T> signalling_coroutine run_and_signal(std::binary_semaphore & /* taken by the promise */, task<T> &t, std::optional<T> &value, std::exception_ptr &exception)
+{
+    try
+    {
+        value.emplace(co_await t);
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+}
+} // namespace detail
+
+template <class T> T sync_wait(task<T> t)
+{
+    std::binary_semaphore done(0);
+    std::optional<T> value;
+    std::exception_ptr exception;
+    detail::run_and_signal(done, t, value, exception);
+    done.acquire();
+    if (exception)
+        std::rethrow_exception(exception);
+    return std::move(*value);
+}
+
+template <class E>
+concept executor = requires(E &e, std::function<void()> fn) { e.post(std::move(fn)); };
+
+class worker_pool
+{
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> queue;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    void work()
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            job();
+        }
+    }
+
+public:
+    explicit worker_pool(unsigned num_threads = std::max(std::thread::hardware_concurrency(), 1u))
+    {
+        threads.reserve(num_threads);
+        for (unsigned t = 0; t < num_threads; ++t)
+            threads.emplace_back([this] { work(); });
+    }
+
+    worker_pool(const worker_pool &) = delete;
+    worker_pool &operator=(const worker_pool &) = delete;
+
+    // Finishes queued work, then joins the threads.
+    ~worker_pool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    // Notifies under the lock: a job posted by a worker may be what lets the pool's owner go on to
+    // destroy it, which must not happen while this call still touches the condition variable.
+    void post(std::function<void()> job)
+    {
+        std::lock_guard lock(mutex);
+        queue.push_back(std::move(job));
+        wake.notify_one();
+    }
+
+    // Awaitable that runs fn on a worker, then resumes the awaiting coroutine through home, not on
+    // the worker. Exceptions from fn are rethrown in the coroutine.
+    template <class Fn, executor Executor> auto run(Fn fn, Executor &home)
+    {
+        struct awaiter
+        {
+            worker_pool &pool;
+            Executor &home;
+            Fn fn;
+            std::exception_ptr exception;
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+            void await_suspend(std::coroutine_handle<> h)
+            {
+                pool.post([this, h] {
+                    try
+                    {
+                        fn();
+                    }
+                    catch (...)
+                    {
+                        exception = std::current_exception();
+                    }
+                    home.post([h] { h.resume(); });
+                });
+            }
+            void await_resume()
+            {
+                if (exception)
+                    std::rethrow_exception(exception);
+            }
+        };
+        return awaiter{*this, home, std::move(fn), {}};
+    }
+};
+
+template <class Source, class Src>
+concept async_chunk_source = requires(Source &source) {
+    { source.next().await_resume() } -> std::convertible_to<std::optional<std::span<const Src>>>;
+};
+
+template <class Src> struct validation_result
+{
+    range_stats<Src> stats;
+    std::size_t chunks = 0;
+    std::size_t offloaded_chunks = 0;
+};
+
+// Chunks of at least this many bytes are handed to the pool by default; below it the check
+// takes less time than a round trip to another thread.
+constexpr std::size_t default_offload_threshold_bytes = std::size_t(256) << 10;
+
+template <class Dst, class Src, class Source, class Executor = worker_pool>
+    requires range_checkable<Dst, Src> && async_chunk_source<Source, Src> && executor<Executor>
+task<validation_result<Src>> validate_async(Source &source, worker_pool *pool = nullptr, Executor *home = nullptr,
+                                            std::size_t offload_threshold = default_offload_threshold_bytes / sizeof(Src))
+{
+    IN_RANGE_EXT_ASSERT(pool == nullptr || home != nullptr);
+    range_validator<Dst, Src> validator;
+    validation_result<Src> result;
+
+    for (;;)
+    {
+        const std::optional<std::span<const Src>> chunk = co_await source.next();
+        if (!chunk)
+            break;
+
+        ++result.chunks;
+        if (pool != nullptr && chunk->size() >= offload_threshold)
+        {
+            ++result.offloaded_chunks;
+            co_await pool->run([&validator, chunk] { validator.feed(*chunk); }, *home);
+        }
+        else
+            validator.feed(*chunk);
+    }
+
+    result.stats = validator.stats();
+    co_return result;
+}
+} // namespace in_range_ext
+
+#endif // IN_RANGE_EXT_CORO_H
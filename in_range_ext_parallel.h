@@ -0,0 +1,265 @@
+//
+// Parallel, NUMA-aware validation for in_range_ext.h.
+//
+// It defines the following in namespace in_range_ext
+//
+// struct parallel_options
+//
+//   num_threads: worker threads (0 for std::thread::hardware_concurrency())
+//   chunk_bytes: size of the pieces the input is divided into
+//   numa_aware:  schedule pieces on the NUMA node holding their memory
+//
+// template<class Dst, class Src> range_stats<Src> parallel_validate(span<const Src> src, const parallel_options &options = {})
+//
+//   checks src against the range of Dst on several threads, returning the same statistics as a
+//   range_validator fed the whole of src.
+//
+// On Linux machines with more than one NUMA node, the node holding the first page of each chunk is
+// found with move_pages(2) (which only queries when no target nodes are given), each node gets a
+// queue of its chunks, and its share of the threads is pinned to its CPUs, so that memory is read
+// from the local socket. Threads that run out of local work take chunks from other nodes' queues.
+// Pages not yet faulted in are spread over the nodes. On single-node machines, or if the node
+// cannot be queried, all threads share one queue.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IN_RANGE_EXT_PARALLEL_H
+#define IN_RANGE_EXT_PARALLEL_H
+
+#include "in_range_ext.h"
+
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace in_range_ext
+{
+struct parallel_options
+{
+    unsigned num_threads = 0;
+    std::size_t chunk_bytes = std::size_t(4) << 20;
+    bool numa_aware = true;
+};
+
+namespace detail
+{
+struct numa_node
+{
+    int id;
+    std::vector<int> cpus;
+};
+
+// Parses a sysfs CPU list such as "0-3,8,10-11".
+inline std::vector<int> parse_cpu_list(std::string_view list)
+{
+    std::vector<int> cpus;
+    while (!list.empty())
+    {
+        const std::size_t comma = list.find(',');
+        const std::string_view range = list.substr(0, comma);
+        list = comma == list.npos ? std::string_view() : list.substr(comma + 1);
+
+        const std::size_t dash = range.find('-');
+        const int first = std::stoi(std::string(range.substr(0, dash)));
+        const int last = dash == range.npos ? first : std::stoi(std::string(range.substr(dash + 1)));
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+// Online NUMA nodes with CPUs; empty if unknown.
+inline std::vector<numa_node> numa_nodes()
+{
+    std::vector<numa_node> nodes;
+#ifdef __linux__
+    try
+    {
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string list;
+        if (!(online >> list))
+            return nodes;
+        for (const int id : parse_cpu_list(list))
+        {
+            std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+            std::string cpus;
+            if (cpulist >> cpus)
+                nodes.push_back({id, parse_cpu_list(cpus)});
+        }
+    }
+    catch (const std::exception &)
+    {
+        nodes.clear();
+    }
+#endif
+    return nodes;
+}
+
+// Sets status[k] to the node holding pages[k], or a negative errno value if it is not known (e.g.
+// -ENOENT for a page not yet faulted in). Returns false if the query is not possible.
+inline bool nodes_of_pages([[maybe_unused]] const void *const *pages, [[maybe_unused]] std::size_t count, [[maybe_unused]] int *status)
+{
+#if defined __linux__ && defined SYS_move_pages
+    constexpr std::size_t batch = 4096;
+    for (std::size_t k = 0; k < count; k += batch)
+    {
+        const std::size_t n = std::min(batch, count - k);
+        if (::syscall(SYS_move_pages, 0, n, pages + k, nullptr, status + k, 0) < 0)
+            return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Restricts the calling thread to the given CPUs, ignoring failure.
+inline void pin_to_cpus([[maybe_unused]] const std::vector<int> &cpus)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : cpus)
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+    ::sched_setaffinity(0, sizeof set, &set);
+#endif
+}
+} // namespace detail
+
+template <class Dst, class Src>
+    requires range_checkable<Dst, Src>
+range_stats<Src> parallel_validate(std::span<const Src> src, const parallel_options &options = {})
+{
+    using bounds = detail::range_bounds<Dst, Src>;
+
+    const std::size_t chunk_size = std::max<std::size_t>(options.chunk_bytes / sizeof(Src), 1);
+    const std::size_t num_chunks = (src.size() + chunk_size - 1) / chunk_size;
+    unsigned num_threads = options.num_threads != 0 ? options.num_threads : std::thread::hardware_concurrency();
+    num_threads = unsigned(std::clamp<std::size_t>(num_threads, 1, std::max<std::size_t>(num_chunks, 1)));
+
+    // Per-chunk statistics, merged in order at the end.
+    std::vector<range_stats<Src>> chunk_stats(num_chunks);
+    auto check_chunk = [&](std::size_t c) {
+        const std::size_t begin = c * chunk_size;
+        detail::accumulate(chunk_stats[c], src.data() + begin, std::min(chunk_size, src.size() - begin), 0, bounds::min_in_range, bounds::max_in_range);
+    };
+
+    // One queue of chunks per NUMA node, or a single queue.
+    std::vector<detail::numa_node> nodes;
+    if (options.numa_aware && num_threads > 1)
+        nodes = detail::numa_nodes();
+    std::vector<std::vector<std::size_t>> queues(1);
+    if (nodes.size() > 1)
+    {
+        std::vector<const void *> pages(num_chunks);
+        std::vector<int> status(num_chunks);
+        for (std::size_t c = 0; c < num_chunks; ++c)
+            pages[c] = src.data() + c * chunk_size;
+        if (detail::nodes_of_pages(pages.data(), num_chunks, status.data()))
+        {
+            queues.assign(nodes.size(), {});
+            for (std::size_t c = 0; c < num_chunks; ++c)
+            {
+                std::size_t q = c % nodes.size(); // Unknown node.
+                for (std::size_t n = 0; n < nodes.size(); ++n)
+                    if (nodes[n].id == status[c])
+                        q = n;
+                queues[q].push_back(c);
+            }
+        }
+        else
+            nodes.clear();
+    }
+    if (queues.size() == 1)
+    {
+        nodes.clear();
+        queues[0].resize(num_chunks);
+        for (std::size_t c = 0; c < num_chunks; ++c)
+            queues[0][c] = c;
+    }
+
+    const std::unique_ptr<std::atomic<std::size_t>[]> next(new std::atomic<std::size_t>[queues.size()]);
+    for (std::size_t q = 0; q < queues.size(); ++q)
+        next[q] = 0;
+
+    // Drains queue `home` first, then the others.
+    auto work = [&](std::size_t home) {
+        if (!nodes.empty())
+            detail::pin_to_cpus(nodes[home].cpus);
+        for (std::size_t i = 0; i < queues.size(); ++i)
+        {
+            const std::size_t q = (home + i) % queues.size();
+            for (std::size_t k; (k = next[q].fetch_add(1, std::memory_order_relaxed)) < queues[q].size();)
+                check_chunk(queues[q][k]);
+        }
+    };
+
+    if (num_threads == 1)
+        work(0);
+    else
+    {
+        // Threads are shared among queues in proportion to their chunks. They are jthreads, so if
+        // starting one throws, those already started are joined before the exception leaves.
+        std::vector<std::jthread> threads;
+        threads.reserve(num_threads);
+        for (unsigned t = 0; t < num_threads; ++t)
+        {
+            std::size_t home = 0, cumulative = 0;
+            for (std::size_t q = 0; q < queues.size(); ++q)
+            {
+                cumulative += queues[q].size();
+                if (t * num_chunks < cumulative * num_threads)
+                {
+                    home = q;
+                    break;
+                }
+            }
+            threads.emplace_back(work, home);
+        }
+    }
+
+    range_stats<Src> stats;
+    for (const range_stats<Src> &part : chunk_stats)
+        merge(stats, part);
+    return stats;
+}
+} // namespace in_range_ext
+
+#endif // IN_RANGE_EXT_PARALLEL_H
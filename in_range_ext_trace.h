@@ -0,0 +1,356 @@
+//
+// Sampled failure tracing for in_range_ext.h. Requires IN_RANGE_EXT_TRACE to be defined (in every
+// translation unit); otherwise this header defines nothing.
+//
+// It defines the following in namespace in_range_ext
+//
+// struct trace_options
+//
+//   sample_size:    failures kept per thread
+//   ring_capacity:  captured failures that can await the drain thread, a power of 2
+//   drain_interval: how often the drain thread empties the ring
+//
+// class failure_tracer
+//
+//   while it exists, installed as the failure hook: each thread keeps a reservoir sample of its
+//   failures (Li's algorithm L, so that a failure not sampled costs a thread-local count and
+//   compare), pushing the sampled records into a lock-free ring buffer. A background thread drains
+//   the ring, passes each record to an optional sink and keeps the reservoirs, returned by sample().
+//   At most one failure_tracer may exist at a time.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IN_RANGE_EXT_TRACE_H
+#define IN_RANGE_EXT_TRACE_H
+
+#include "in_range_ext.h"
+
+#ifdef IN_RANGE_EXT_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace in_range_ext
+{
+struct trace_options
+{
+    std::size_t sample_size = 16;
+    std::size_t ring_capacity = 1024;
+    std::chrono::milliseconds drain_interval{10};
+};
+
+class failure_tracer;
+
+namespace detail
+{
+// Per-thread sampling state. busy is set while the thread is inside the hook, so that a tracer
+// being destroyed can wait for it.
+struct thread_sampler
+{
+    std::atomic<bool> busy{false};
+    std::uint64_t generation = 0; // Of the tracer the rest of the state belongs to.
+    unsigned thread = 0;          // Index of this thread's reservoir.
+    std::uint64_t seen = 0;       // Failures so far.
+    std::uint64_t next = 1;       // Ordinal of the next failure to sample.
+    double w = 0;
+    std::uint64_t random = 0;
+
+    thread_sampler();
+    ~thread_sampler();
+    thread_sampler(const thread_sampler &) = delete;
+    thread_sampler &operator=(const thread_sampler &) = delete;
+
+    // Uniform in (0, 1), by xorshift64*.
+    double uniform()
+    {
+        random ^= random >> 12;
+        random ^= random << 25;
+        random ^= random >> 27;
+        return (double((random * 0x2545f4914f6cdd1dull) >> 11) + 0.5) * 0x1p-53;
+    }
+};
+
+struct tracer_registry
+{
+    std::mutex mutex;
+    std::vector<thread_sampler *> samplers;
+    std::atomic<failure_tracer *> active{nullptr};
+    std::atomic<std::uint64_t> generations{0};
+};
+
+inline tracer_registry &tracers()
+{
+    static tracer_registry instance;
+    return instance;
+}
+
+inline thread_sampler::thread_sampler()
+{
+    std::lock_guard lock(tracers().mutex);
+    tracers().samplers.push_back(this);
+}
+
+inline thread_sampler::~thread_sampler()
+{
+    std::lock_guard lock(tracers().mutex);
+    std::erase(tracers().samplers, this);
+}
+} // namespace detail
+
+// failure_tracer
+class failure_tracer
+{
+public:
+    using sink = std::function<void(const failure_record &)>;
+
+    // Installs the tracer as the failure hook and starts the drain thread. capture_sink, if given, is
+    // called on that thread with each sampled record, and must not throw.
+    explicit failure_tracer(sink capture_sink = {}, const trace_options &options = {})
+        : on_capture(std::move(capture_sink)), sample_size(options.sample_size), drain_interval(options.drain_interval),
+          ring_mask(options.ring_capacity - 1), ring(new cell[options.ring_capacity]),
+          generation(detail::tracers().generations.fetch_add(1) + 1)
+    {
+        IN_RANGE_EXT_ASSERT(sample_size > 0 && std::has_single_bit(options.ring_capacity));
+        for (std::size_t k = 0; k < options.ring_capacity; ++k)
+            ring[k].sequence.store(k, std::memory_order_relaxed);
+
+        failure_tracer *expected = nullptr;
+        IN_RANGE_EXT_ASSERT(detail::tracers().active.compare_exchange_strong(expected, this));
+        previous_hook = set_failure_hook(&capture);
+        drainer = std::thread([this] { drain_loop(); });
+    }
+
+    failure_tracer(const failure_tracer &) = delete;
+    failure_tracer &operator=(const failure_tracer &) = delete;
+
+    // Uninstalls the tracer, waits for threads inside the hook, and delivers everything captured.
+    ~failure_tracer()
+    {
+        set_failure_hook(previous_hook);
+        detail::tracers().active.store(nullptr);
+        {
+            std::lock_guard lock(detail::tracers().mutex);
+            for (const detail::thread_sampler *sampler : detail::tracers().samplers)
+                while (sampler->busy.load())
+                    std::this_thread::yield();
+        }
+        {
+            std::lock_guard lock(stop_mutex);
+            stopping = true;
+        }
+        stop_signal.notify_one();
+        drainer.join();
+    }
+
+    // Delivers every record captured so far, without waiting for the drain thread.
+    void flush()
+    {
+        std::lock_guard lock(consume_mutex);
+        for (;;)
+        {
+            cell &c = ring[consume_position & ring_mask];
+            if (c.sequence.load(std::memory_order_acquire) != consume_position + 1)
+                break;
+            const failure_record record = c.record;
+            const unsigned thread = c.thread;
+            const std::size_t slot = c.slot;
+            c.sequence.store(consume_position + ring_mask + 1, std::memory_order_release);
+            ++consume_position;
+
+            {
+                std::lock_guard sample_lock(sample_mutex);
+                if (reservoirs.size() <= thread)
+                    reservoirs.resize(thread + 1);
+                reservoirs[thread].resize(sample_size);
+                reservoirs[thread][slot] = record;
+            }
+            if (on_capture)
+                on_capture(record);
+        }
+    }
+
+    // The records currently in every thread's reservoir, as delivered so far.
+    std::vector<failure_record> sample() const
+    {
+        std::lock_guard lock(sample_mutex);
+        std::vector<failure_record> records;
+        for (const auto &reservoir : reservoirs)
+            for (const auto &record : reservoir)
+                if (record)
+                    records.push_back(*record);
+        return records;
+    }
+
+    // Sampled records lost because the ring was full.
+    std::uint64_t dropped() const
+    {
+        return num_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct cell
+    {
+        std::atomic<std::size_t> sequence;
+        failure_record record;
+        unsigned thread = 0;
+        std::size_t slot = 0;
+    };
+
+    static detail::thread_sampler &thread_state()
+    {
+        thread_local detail::thread_sampler state;
+        return state;
+    }
+
+    // The failure hook. The busy flag and the active pointer are written and read in opposite
+    // orders here and in the destructor, with sequentially consistent operations, so either the
+    // destructor sees the flag or this sees the tracer gone.
+    static void capture(const failure_record &record)
+    {
+        detail::thread_sampler &state = thread_state();
+        state.busy.store(true);
+        if (failure_tracer *tracer = detail::tracers().active.load())
+            tracer->offer(state, record);
+        state.busy.store(false, std::memory_order_release);
+    }
+
+    // Algorithm L: the first sample_size failures fill the reservoir; after that the gaps between
+    // sampled failures are drawn directly, each sampled one replacing a random slot, so that the
+    // reservoir stays a uniform sample of all the thread's failures.
+    void offer(detail::thread_sampler &state, const failure_record &record)
+    {
+        if (state.generation != generation)
+        {
+            state.generation = generation;
+            state.thread = next_thread.fetch_add(1, std::memory_order_relaxed);
+            state.seen = 0;
+            state.next = 1;
+            state.random = 0x9e3779b97f4a7c15ull ^ (std::uint64_t(std::uintptr_t(&state)) * (generation | 1));
+        }
+
+        if (++state.seen < state.next)
+            return;
+
+        std::size_t slot;
+        if (state.seen <= sample_size)
+            slot = std::size_t(state.seen - 1);
+        else
+            slot = std::size_t(state.uniform() * double(sample_size)) % sample_size;
+
+        if (state.seen < sample_size)
+            state.next = state.seen + 1;
+        else
+        {
+            state.w = (state.seen == sample_size ? 1.0 : state.w) * std::exp(std::log(state.uniform()) / double(sample_size));
+            const double gap = std::floor(std::log(state.uniform()) / std::log1p(-state.w));
+            state.next = state.seen + 1 + (gap < 0x1p62 ? std::uint64_t(gap) : std::uint64_t(1) << 62);
+        }
+
+        if (!push(record, state.thread, slot))
+            num_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Bounded multi-producer queue (Vyukov): each cell's sequence says whether it is free for the
+    // producer at a given position or holds a record for the consumer.
+    bool push(const failure_record &record, unsigned thread, std::size_t slot)
+    {
+        std::size_t position = produce_position.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell &c = ring[position & ring_mask];
+            const std::size_t sequence = c.sequence.load(std::memory_order_acquire);
+            const auto difference = std::intptr_t(sequence) - std::intptr_t(position);
+            if (difference == 0)
+            {
+                if (produce_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    c.record = record;
+                    c.thread = thread;
+                    c.slot = slot;
+                    c.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+                return false; // Full.
+            else
+                position = produce_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    void drain_loop()
+    {
+        std::unique_lock lock(stop_mutex);
+        while (!stopping)
+        {
+            lock.unlock();
+            flush();
+            lock.lock();
+            stop_signal.wait_for(lock, drain_interval, [this] { return stopping; });
+        }
+        lock.unlock();
+        flush();
+    }
+
+    const sink on_capture;
+    const std::size_t sample_size;
+    const std::chrono::milliseconds drain_interval;
+
+    const std::size_t ring_mask;
+    const std::unique_ptr<cell[]> ring;
+    alignas(64) std::atomic<std::size_t> produce_position{0};
+    alignas(64) std::size_t consume_position = 0;
+    std::mutex consume_mutex;
+
+    const std::uint64_t generation;
+    std::atomic<unsigned> next_thread{0};
+    std::atomic<std::uint64_t> num_dropped{0};
+    failure_hook previous_hook = nullptr;
+
+    mutable std::mutex sample_mutex;
+    std::vector<std::vector<std::optional<failure_record>>> reservoirs;
+
+    std::mutex stop_mutex;
+    std::condition_variable stop_signal;
+    bool stopping = false;
+    std::thread drainer;
+};
+} // namespace in_range_ext
+
+#endif // IN_RANGE_EXT_TRACE
+
+#endif // IN_RANGE_EXT_TRACE_H
@@ -0,0 +1,432 @@
+//
+// io_uring file validation pipeline for in_range_ext.h (Linux only).
+//
+// It defines the following in namespace in_range_ext
+//
+// struct uring_options
+//
+//   buffer_size: bytes per read, a multiple of sizeof(Src) (and of the 4096-byte block size for
+//                direct_io, which rounds the last read up to a whole block)
+//   queue_depth: number of reads kept in flight
+//   direct_io:   open the file with O_DIRECT, bypassing the page cache
+//
+// template<class Src> struct file_stats
+//
+//   range_stats for the values in a file, plus the number of bytes read and of trailing bytes that
+//   did not make up a whole value
+//
+// template<class Dst, class Src> file_stats<Src> validate_file(const char *path, const uring_options &options = {})
+//
+//   reads a file of native-endian Src values and checks them against the range of Dst, keeping
+//   queue_depth reads into registered buffers in flight while completed buffers are checked, in
+//   file order, by range_validator. Falls back to plain pread() if io_uring is not available (e.g.
+//   disabled by seccomp) or the buffers cannot be registered (RLIMIT_MEMLOCK). Throws
+//   std::system_error on I/O errors.
+//
+// The ring is driven with the raw system calls, so liburing is not needed.
+//
+// -------------------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------------------
+//
+// MIT License
+//
+// Copyright (c) 2024 stravager
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef IN_RANGE_EXT_URING_H
+#define IN_RANGE_EXT_URING_H
+
+#include "in_range_ext.h"
+
+#if defined __linux__ && defined __has_include
+#if __has_include(<linux/io_uring.h>)
+#define IN_RANGE_EXT_HAS_URING 1
+#endif
+#endif
+
+#ifdef IN_RANGE_EXT_HAS_URING
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace in_range_ext
+{
+struct uring_options
+{
+    std::size_t buffer_size = std::size_t(1) << 20;
+    unsigned queue_depth = 4;
+    bool direct_io = false;
+};
+
+template <class Src> struct file_stats
+{
+    range_stats<Src> values;
+    std::size_t bytes = 0;
+    std::size_t trailing_bytes = 0;
+};
+
+namespace detail
+{
+[[noreturn]] inline void throw_errno(int error, const char *what)
+{
+    throw std::system_error(error, std::generic_category(), what);
+}
+
+// Minimal io_uring wrapper: one submission at a time of reads into registered buffers, waiting for
+// completions one at a time.
+class uring
+{
+    int fd = -1;
+    void *sq_ring = MAP_FAILED, *cq_ring = MAP_FAILED;
+    std::size_t sq_ring_size = 0, cq_ring_size = 0;
+    io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    std::size_t sqes_size = 0;
+
+    unsigned *sq_tail = nullptr, *sq_mask = nullptr, *sq_array = nullptr;
+    unsigned *cq_head = nullptr, *cq_tail = nullptr, *cq_mask = nullptr;
+    io_uring_cqe *cqes = nullptr;
+
+    void *map(std::size_t size, off_t offset)
+    {
+        void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+        if (p == MAP_FAILED)
+            throw_errno(errno, "io_uring mmap");
+        return p;
+    }
+
+    void release()
+    {
+        if (sqes != MAP_FAILED)
+            ::munmap(sqes, sqes_size);
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+            ::munmap(cq_ring, cq_ring_size);
+        if (sq_ring != MAP_FAILED)
+            ::munmap(sq_ring, sq_ring_size);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+public:
+    explicit uring(unsigned entries)
+    {
+        io_uring_params params{};
+        fd = int(::syscall(SYS_io_uring_setup, entries, &params));
+        if (fd < 0)
+            throw_errno(errno, "io_uring_setup");
+
+        try
+        {
+            sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single_mmap)
+                sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+            sq_ring = map(sq_ring_size, IORING_OFF_SQ_RING);
+            cq_ring = single_mmap ? sq_ring : map(cq_ring_size, IORING_OFF_CQ_RING);
+            sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe *>(map(sqes_size, IORING_OFF_SQES));
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+
+        auto *sq = static_cast<unsigned char *>(sq_ring);
+        sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+        auto *cq = static_cast<unsigned char *>(cq_ring);
+        cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    uring(const uring &) = delete;
+    uring &operator=(const uring &) = delete;
+
+    ~uring()
+    {
+        release();
+    }
+
+    void register_buffers(const iovec *buffers, unsigned count)
+    {
+        if (::syscall(SYS_io_uring_register, fd, IORING_REGISTER_BUFFERS, buffers, count) < 0)
+            throw_errno(errno, "io_uring_register");
+    }
+
+    // Queues and submits a read of length bytes at offset into registered buffer buffer_index,
+    // starting at address buffer (which must lie within it).
+    void read_fixed(int file, void *buffer, unsigned length, std::uint64_t offset, unsigned buffer_index, std::uint64_t user_data)
+    {
+        const unsigned tail = *sq_tail; // Only this thread writes the tail.
+        const unsigned index = tail & *sq_mask;
+
+        io_uring_sqe &sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof sqe);
+        sqe.opcode = IORING_OP_READ_FIXED;
+        sqe.fd = file;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+        sqe.len = length;
+        sqe.off = offset;
+        sqe.buf_index = std::uint16_t(buffer_index);
+        sqe.user_data = user_data;
+
+        sq_array[index] = index;
+        std::atomic_ref<unsigned>(*sq_tail).store(tail + 1, std::memory_order_release);
+
+        while (::syscall(SYS_io_uring_enter, fd, 1, 0, 0, nullptr, 0) < 0)
+            if (errno != EINTR)
+                throw_errno(errno, "io_uring_enter");
+    }
+
+    // Waits for and consumes the next completion.
+    io_uring_cqe wait()
+    {
+        for (;;)
+        {
+            const unsigned head = *cq_head; // Only this thread writes the head.
+            if (head != std::atomic_ref<unsigned>(*cq_tail).load(std::memory_order_acquire))
+            {
+                const io_uring_cqe cqe = cqes[head & *cq_mask];
+                std::atomic_ref<unsigned>(*cq_head).store(head + 1, std::memory_order_release);
+                return cqe;
+            }
+
+            if (::syscall(SYS_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+                throw_errno(errno, "io_uring_enter");
+        }
+    }
+};
+
+struct file_descriptor
+{
+    int fd;
+    ~file_descriptor()
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+};
+
+struct free_deleter
+{
+    void operator()(void *p) const
+    {
+        std::free(p);
+    }
+};
+
+// Rounds a read length up to the O_DIRECT block size (block is 1 for buffered reads).
+constexpr std::size_t read_length(std::size_t wanted, std::size_t block) noexcept
+{
+    return (wanted + block - 1) / block * block;
+}
+
+// Synchronous fallback: the same validation with one buffer and pread(). buffer_size is a multiple
+// of block; a read that stops short of a block boundary has hit the end of the file.
+template <class Dst, class Src>
+void validate_fd_pread(int fd, std::size_t size, unsigned char *buffer, std::size_t buffer_size, std::size_t block, range_validator<Dst, Src> &validator,
+                       std::size_t &bytes)
+{
+    while (bytes < size)
+    {
+        std::size_t filled = 0;
+        while (filled < buffer_size && bytes + filled < size)
+        {
+            const std::size_t wanted = std::min(buffer_size - filled, size - bytes - filled);
+            const ssize_t n = ::pread(fd, buffer + filled, read_length(wanted, block), off_t(bytes + filled));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                throw_errno(errno, "pread");
+            if (n == 0)
+                break;
+            filled += std::min(std::size_t(n), wanted);
+            if (filled % block != 0)
+                break;
+        }
+        validator.feed(std::span<const Src>(reinterpret_cast<const Src *>(buffer), filled / sizeof(Src)));
+        bytes += filled;
+        if (filled < buffer_size)
+            return; // End of file, possibly earlier than fstat said.
+    }
+}
+} // namespace detail
+
+template <class Dst, class Src>
+    requires range_checkable<Dst, Src>
+file_stats<Src> validate_file(const char *path, const uring_options &options = {})
+{
+    constexpr std::size_t alignment = 4096;
+    const std::size_t buffer_size = options.buffer_size;
+    const unsigned queue_depth = std::max(options.queue_depth, 1u);
+    IN_RANGE_EXT_ASSERT(buffer_size != 0 && buffer_size % sizeof(Src) == 0 && buffer_size <= std::size_t(UINT_MAX));
+    IN_RANGE_EXT_ASSERT(!options.direct_io || buffer_size % alignment == 0);
+
+    const detail::file_descriptor file{::open(path, O_RDONLY | O_CLOEXEC | (options.direct_io ? O_DIRECT : 0))};
+    if (file.fd < 0)
+        detail::throw_errno(errno, "open");
+    struct stat st;
+    if (::fstat(file.fd, &st) < 0)
+        detail::throw_errno(errno, "fstat");
+    const auto size = std::size_t(st.st_size);
+
+    std::unique_ptr<unsigned char, detail::free_deleter> buffers(
+        static_cast<unsigned char *>(std::aligned_alloc(alignment, (buffer_size * queue_depth + alignment - 1) / alignment * alignment)));
+    if (!buffers)
+        throw std::bad_alloc();
+
+    range_validator<Dst, Src> validator;
+    file_stats<Src> result;
+
+    // Without io_uring, or when the buffers cannot be registered (ENOMEM, or EPERM on older kernels,
+    // beyond RLIMIT_MEMLOCK), the file is read with pread().
+    std::unique_ptr<detail::uring> ring;
+    try
+    {
+        ring = std::make_unique<detail::uring>(queue_depth);
+        std::vector<iovec> iovecs(queue_depth);
+        for (unsigned s = 0; s < queue_depth; ++s)
+            iovecs[s] = {buffers.get() + s * buffer_size, buffer_size};
+        ring->register_buffers(iovecs.data(), queue_depth);
+    }
+    catch (const std::system_error &e)
+    {
+        if (e.code() != std::errc::function_not_supported && e.code() != std::errc::operation_not_permitted &&
+            e.code() != std::errc::permission_denied && e.code() != std::errc::not_enough_memory)
+            throw;
+        ring.reset();
+    }
+
+    // O_DIRECT reads must cover whole blocks, so the last one is rounded up and only the bytes up to
+    // the size from fstat are checked.
+    const std::size_t block = options.direct_io ? alignment : 1;
+    if (!ring)
+        detail::validate_fd_pread(file.fd, size, buffers.get(), buffer_size, block, validator, result.bytes);
+    else
+    {
+        // Each slot reads one buffer_size piece of the file at a time; slots are issued and
+        // consumed round robin, so consuming them in slot order checks the file in order.
+        struct slot
+        {
+            std::size_t offset = 0, length = 0, filled = 0;
+            bool pending = false; // Started and not yet checked.
+            bool busy = false;    // Read in flight.
+        };
+        std::vector<slot> slots(queue_depth);
+        std::size_t next_offset = 0;
+        unsigned in_flight = 0;
+
+        auto issue = [&](unsigned s) {
+            slot &sl = slots[s];
+            ring->read_fixed(file.fd, buffers.get() + s * buffer_size + sl.filled, unsigned(detail::read_length(sl.length - sl.filled, block)),
+                             sl.offset + sl.filled, s, s);
+            sl.busy = true;
+            ++in_flight;
+        };
+        auto start = [&](unsigned s) {
+            if (next_offset >= size)
+                return;
+            slots[s] = {.offset = next_offset, .length = std::min(buffer_size, size - next_offset), .pending = true};
+            next_offset += slots[s].length;
+            issue(s);
+        };
+
+        try
+        {
+            for (unsigned s = 0; s < queue_depth; ++s)
+                start(s);
+
+            bool eof = false;
+            for (unsigned s = 0; slots[s].pending; s = (s + 1) % queue_depth)
+            {
+                // Wait for this slot, recording completions of any others, and finish short reads.
+                // A read that stops short of a block boundary has hit the end of the file.
+                while (slots[s].busy)
+                {
+                    const io_uring_cqe cqe = ring->wait();
+                    --in_flight;
+                    slot &done = slots[cqe.user_data];
+                    done.busy = false;
+                    if (cqe.res < 0)
+                        detail::throw_errno(-cqe.res, "io_uring read");
+                    done.filled = std::min(done.filled + std::size_t(cqe.res), done.length);
+                    if (cqe.res > 0 && done.filled < done.length && done.filled % block == 0)
+                        issue(unsigned(cqe.user_data));
+                }
+
+                // Check this buffer while the other reads are in flight.
+                slot &sl = slots[s];
+                sl.pending = false;
+                if (!eof)
+                {
+                    validator.feed(std::span<const Src>(reinterpret_cast<const Src *>(buffers.get() + s * buffer_size), sl.filled / sizeof(Src)));
+                    result.bytes += sl.filled;
+                    eof = sl.filled < sl.length; // File shrank since fstat.
+                }
+                if (!eof)
+                    start(s);
+            }
+        }
+        catch (...)
+        {
+            // The kernel may still be writing into the buffers: wait for the outstanding reads before
+            // the ring and the buffers go away, or leak the buffers if even that fails.
+            try
+            {
+                for (; in_flight != 0; --in_flight)
+                    ring->wait();
+            }
+            catch (...)
+            {
+                buffers.release();
+            }
+            throw;
+        }
+    }
+
+    result.values = validator.stats();
+    result.trailing_bytes = result.bytes % sizeof(Src);
+    return result;
+}
+} // namespace in_range_ext
+
+#endif // IN_RANGE_EXT_HAS_URING
+
+#endif // IN_RANGE_EXT_URING_H